@@ -0,0 +1,511 @@
+#include <omnetpp.h>
+#include <omnetpp/cnullenvir.h>
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+#include "PatternTable.h"
+#include "CacheEntry.h"
+#include "ResponseCache.h"
+#include "CachePolicy.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace omnetpp;
+
+/**
+ * Microbenchmarks of the prediction and cache data structures
+ * Drives PatternTable, CacheEntry and the server's cache lookup/insert/evict
+ * path directly, without the event loop or any module. The kernel library is
+ * still linked: CacheEntry, ResponseCache and PatternTable read the clock
+ * through simTime(), so a cSimulation with a cNullEnvir is set up to own that
+ * clock and it is advanced by hand between operations. No event is ever
+ * scheduled, so what is timed is the data structures alone.
+ * Access sequences (Zipf, sequential, 80/20 Markov) are generated before
+ * timing. Each case runs in its own child process so that its peak RSS is its
+ * own; every case prints one JSON line with ns/op, allocations/op and peak RSS,
+ * or with "error" if it failed or ran out of its memory limit.
+ *
+ *   httpcache_bench [--sizes 10,1000,...] [--ops N] [--patterns zipf,...]
+ *                   [--policies lru,...] [--filter text] [--seed N]
+ */
+
+namespace {
+
+// Every operator new in the process counts, including those of std containers
+size_t allocationCount = 0;
+
+struct Options
+{
+    std::vector<int> sizes = {10, 100, 1000, 10000, 100000, 1000000};
+    std::vector<std::string> patterns = {"zipf", "sequential", "markov"};
+    std::vector<std::string> policies = {"lru", "lfu", "fifo", "arc", "tinylfu", "gds"};
+    size_t ops = 1 << 20;
+    std::string filter;  // Only benchmarks whose name contains this
+    uint32_t seed = 1;
+    double zipfExponent = 1.0;
+    long memoryLimitMb = 4096;  // Address space of one case, 0 = unlimited
+};
+
+struct Measurement
+{
+    double nsPerOp = 0;
+    double allocsPerOp = 0;
+    double hitRate = -1;  // Cache path only
+};
+
+const double SIMTIME_STEP = 0.001;  // Simulated time between two operations
+const int CACHE_TTL = 60;  // Entries live for 60000 operations
+volatile size_t sink;  // Keeps results observable
+
+std::vector<std::string> split(const char *list)
+{
+    std::vector<std::string> items;
+    std::string item;
+    for (const char *p = list; ; p++) {
+        if (*p == ',' || *p == '\0') {
+            if (!item.empty()) {
+                items.push_back(item);
+            }
+            item.clear();
+            if (*p == '\0') {
+                break;
+            }
+        } else {
+            item += *p;
+        }
+    }
+    return items;
+}
+
+// Access sequences
+std::vector<int> makeTrace(const std::string& pattern, int pages, const Options& options)
+{
+    std::mt19937_64 rng(options.seed * 0x9E3779B97F4A7C15ULL + pages);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::vector<int> trace(options.ops + 1);
+    
+    if (pattern == "zipf") {
+        // Page rank r has weight 1/r^s; inverse CDF by binary search
+        std::vector<double> cdf(pages);
+        double total = 0;
+        for (int rank = 0; rank < pages; rank++) {
+            total += 1.0 / std::pow(rank + 1.0, options.zipfExponent);
+            cdf[rank] = total;
+        }
+        for (int& page : trace) {
+            page = std::lower_bound(cdf.begin(), cdf.end(), uniform(rng) * total) - cdf.begin();
+            page = std::min(page, pages - 1);
+        }
+    } else if (pattern == "sequential") {
+        for (size_t i = 0; i < trace.size(); i++) {
+            trace[i] = i % pages;
+        }
+    } else if (pattern == "markov") {
+        // 80% follow the page's fixed successor, 20% jump anywhere
+        std::uniform_int_distribution<int> anyPage(0, pages - 1);
+        int page = 0;
+        for (int& next : trace) {
+            next = page;
+            if (uniform(rng) < 0.8) {
+                page = (static_cast<uint64_t>(page) * 2654435761ULL + 1) % pages;
+            } else {
+                page = anyPage(rng);
+            }
+        }
+    } else {
+        throw cRuntimeError("Unknown access pattern '%s' (expected zipf, sequential or markov)", pattern.c_str());
+    }
+    return trace;
+}
+
+// Timed loop over ops operations, body(i) for i = 1..ops
+template <typename Body>
+Measurement measure(size_t ops, Body body)
+{
+    size_t allocationsBefore = allocationCount;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 1; i <= ops; i++) {
+        body(i);
+    }
+    auto end = std::chrono::steady_clock::now();
+    
+    Measurement result;
+    result.nsPerOp = std::chrono::duration<double, std::nano>(end - start).count() / ops;
+    result.allocsPerOp = (double)(allocationCount - allocationsBefore) / ops;
+    return result;
+}
+
+void advanceTime()
+{
+    getSimulation()->setSimTime(simTime() + SIMTIME_STEP);
+}
+
+// PatternTable benchmarks
+Measurement benchRecordTransition(const std::vector<int>& trace, size_t ops)
+{
+    PatternTable table;
+    return measure(ops, [&](size_t i) { table.recordTransition(trace[i - 1], trace[i]); });
+}
+
+Measurement benchTopPredictions(const std::vector<int>& trace, size_t ops)
+{
+    // Server path: reused result storage
+    PatternTable table;
+    for (size_t i = 1; i <= ops; i++) {
+        table.recordTransition(trace[i - 1], trace[i]);
+    }
+    PatternTable::Predictions predictions;
+    return measure(ops, [&](size_t i) { sink += table.getTopPredictions(trace[i], 5, predictions); });
+}
+
+Measurement benchPredictionsWithConfidence(const std::vector<int>& trace, size_t ops)
+{
+    PatternTable table;
+    for (size_t i = 1; i <= ops; i++) {
+        table.recordTransition(trace[i - 1], trace[i]);
+    }
+    return measure(ops, [&](size_t i) { sink += table.getPredictionsWithConfidence(trace[i]).size(); });
+}
+
+// CacheEntry benchmarks
+std::vector<PageContent> makeBodies()
+{
+    // A few shared bodies of typical page sizes
+    std::vector<PageContent> bodies;
+    for (uint32_t tag = 1; tag <= 16; tag++) {
+        bodies.push_back(makeSyntheticContent(1024 * tag, tag));
+    }
+    return bodies;
+}
+
+Measurement benchEntryCopy(const std::vector<int>& trace, size_t ops)
+{
+    std::vector<PageContent> bodies = makeBodies();
+    std::vector<CacheEntry> originals;
+    for (size_t i = 0; i < bodies.size(); i++) {
+        originals.emplace_back(i, bodies[i], CACHE_TTL);
+    }
+    return measure(ops, [&](size_t i) {
+        CacheEntry copy(originals[trace[i] % originals.size()]);
+        sink += copy.getContentSize();
+    });
+}
+
+// ResponseCache benchmarks
+Measurement benchCacheInsert(const std::vector<int>& trace, int pages, size_t ops)
+{
+    // Room for every page: inserts and replacements, no eviction
+    std::vector<PageContent> bodies = makeBodies();
+    ResponseCache cache(pages);
+    CacheEntry entry(0, bodies[0], CACHE_TTL);
+    return measure(ops, [&](size_t i) {
+        entry.setResourceId(trace[i]);
+        entry.setContent(bodies[trace[i] % bodies.size()]);
+        cache.insert(entry);
+    });
+}
+
+Measurement benchServerPath(const std::vector<int>& trace, int pages, const std::string& policy, bool admission, size_t ops)
+{
+    // The lookup and add HttpServer::checkResponseCache and addToCacheWithManagement use
+    std::vector<PageContent> bodies = makeBodies();
+    int capacity = std::max(8, pages / 10);
+    ResponseCache cache(capacity);
+    cache.setPolicy(EvictionPolicy::create(policy, capacity));
+    if (admission) {
+        cache.setAdmissionFilter(new AdmissionFilter(capacity));
+    }
+    
+    size_t hits = 0;
+    Measurement result = measure(ops, [&](size_t i) {
+        advanceTime();
+        int resourceId = trace[i];
+        cache.recordRequest(resourceId);
+        
+        // Lookup
+        bool expired = false;
+        CacheEntry *cached = cache.lookup(resourceId, expired);
+        if (cached) {
+            cached->recordHit();
+            hits++;
+            return;
+        }
+        
+        // Miss: generate and insert with management
+        int expiredCount = 0;
+        cache.add(CacheEntry(resourceId, bodies[resourceId % bodies.size()], CACHE_TTL), simTime(), 1.0, expiredCount);
+    });
+    result.hitRate = (double)hits / ops;
+    return result;
+}
+
+// Peak resident set size of this process in KB
+long peakRssKb()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return (long)(counters.PeakWorkingSetSize / 1024);
+    }
+    return -1;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;  // Bytes on macOS
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+// Output: one JSON object per case
+struct CaseInfo
+{
+    const char *benchmark;
+    std::string policy;  // Empty outside the cache path
+    std::string pattern;
+    int pages;
+    size_t ops;
+};
+
+void reportCase(const CaseInfo& info)
+{
+    std::printf("{\"benchmark\":\"%s\",", info.benchmark);
+    if (!info.policy.empty()) {
+        std::printf("\"policy\":\"%s\",", info.policy.c_str());
+    }
+    std::printf("\"pattern\":\"%s\",\"pages\":%d,\"ops\":%zu", info.pattern.c_str(), info.pages, info.ops);
+}
+
+void report(const CaseInfo& info, const Measurement& result)
+{
+    reportCase(info);
+    std::printf(",\"ns_per_op\":%.2f,\"allocs_per_op\":%.3f,\"peak_rss_kb\":%ld",
+                result.nsPerOp, result.allocsPerOp, peakRssKb());
+    if (result.hitRate >= 0) {
+        std::printf(",\"hit_rate\":%.4f", result.hitRate);
+    }
+    std::printf("}\n");
+    std::fflush(stdout);
+}
+
+void reportError(const CaseInfo& info, const std::string& message)
+{
+    reportCase(info);
+    std::printf(",\"error\":\"");
+    for (char c : message) {
+        if (c == '"' || c == '\\') {
+            std::putchar('\\');
+        }
+        std::putchar(c);
+    }
+    std::printf("\"}\n");
+    std::fflush(stdout);
+}
+
+// One benchmark case, in a child process where fork() exists; returns false on failure
+template <typename Case>
+bool runIsolated(const CaseInfo& info, const Options& options, Case runCase)
+{
+    std::fflush(stdout);
+#ifdef _WIN32
+    // In process: peak RSS is the largest of this and all earlier cases
+    try {
+        runCase();
+    } catch (std::exception& e) {
+        reportError(info, e.what());
+        return false;
+    }
+    return true;
+#else
+    pid_t child = fork();
+    if (child < 0) {
+        reportError(info, std::string("fork: ") + std::strerror(errno));
+        return false;
+    }
+    if (child == 0) {
+        // Over the limit allocations throw std::bad_alloc instead of swapping the machine
+        if (options.memoryLimitMb > 0) {
+            struct rlimit limit;
+            limit.rlim_cur = limit.rlim_max = (rlim_t)options.memoryLimitMb << 20;
+            setrlimit(RLIMIT_AS, &limit);
+        }
+        int code = 0;
+        try {
+            runCase();
+        } catch (std::exception& e) {
+            reportError(info, e.what());
+            code = 1;
+        }
+        std::fflush(stdout);
+        _exit(code);
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    if (WIFSIGNALED(status)) {
+        reportError(info, std::string("terminated by signal ") + std::to_string(WTERMSIG(status)));
+        return false;
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+#endif
+}
+
+bool selected(const Options& options, const char *benchmark)
+{
+    return options.filter.empty() || std::strstr(benchmark, options.filter.c_str()) != nullptr;
+}
+
+int runAll(const Options& options)
+{
+    int failures = 0;
+    size_t ops = options.ops;
+    for (int pages : options.sizes) {
+        for (const std::string& pattern : options.patterns) {
+            auto run = [&](const char *benchmark, const std::string& policy, auto body) {
+                if (!selected(options, benchmark)) {
+                    return;
+                }
+                CaseInfo info = {benchmark, policy, pattern, pages, ops};
+                bool ok = runIsolated(info, options, [&]() {
+                    std::vector<int> trace = makeTrace(pattern, pages, options);
+                    report(info, body(trace));
+                });
+                if (!ok) {
+                    failures++;
+                }
+            };
+            run("pattern.recordTransition", "", [&](const std::vector<int>& trace) { return benchRecordTransition(trace, ops); });
+            run("pattern.getTopPredictions", "", [&](const std::vector<int>& trace) { return benchTopPredictions(trace, ops); });
+            run("pattern.getPredictionsWithConfidence", "", [&](const std::vector<int>& trace) { return benchPredictionsWithConfidence(trace, ops); });
+            run("entry.copy", "", [&](const std::vector<int>& trace) { return benchEntryCopy(trace, ops); });
+            run("cache.insert", "", [&](const std::vector<int>& trace) { return benchCacheInsert(trace, pages, ops); });
+            for (const std::string& policy : options.policies) {
+                run("cache.serverPath", policy, [&](const std::vector<int>& trace) {
+                    return benchServerPath(trace, pages, policy, false, ops);
+                });
+                run("cache.serverPathAdmission", policy, [&](const std::vector<int>& trace) {
+                    return benchServerPath(trace, pages, policy, true, ops);
+                });
+            }
+        }
+    }
+    return failures;
+}
+
+void usage()
+{
+    std::fprintf(stderr,
+        "usage: httpcache_bench [options]\n"
+        "  --sizes N,N,...      page counts (default 10,100,1000,10000,100000,1000000)\n"
+        "  --ops N              operations per case (default 1048576)\n"
+        "  --patterns P,...     zipf, sequential, markov (default all)\n"
+        "  --policies P,...     eviction policies for the cache path (default all)\n"
+        "  --filter TEXT        only benchmarks whose name contains TEXT\n"
+        "  --zipf-exponent S    Zipf exponent (default 1.0)\n"
+        "  --seed N             seed of the access sequences (default 1)\n"
+        "  --memory-limit MB    address space limit of one case, 0 = none (default 4096)\n"
+        "Prints one JSON object per line and case.\n");
+}
+
+bool parseOptions(int argc, char *argv[], Options& options)
+{
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value || std::strncmp(arg, "--", 2) != 0) {
+            return false;
+        }
+        i++;
+        if (!std::strcmp(arg, "--sizes")) {
+            options.sizes.clear();
+            for (const std::string& size : split(value)) {
+                options.sizes.push_back(std::max(1, std::atoi(size.c_str())));
+            }
+        } else if (!std::strcmp(arg, "--ops")) {
+            options.ops = std::max(1L, std::atol(value));
+        } else if (!std::strcmp(arg, "--patterns")) {
+            options.patterns = split(value);
+        } else if (!std::strcmp(arg, "--policies")) {
+            options.policies = split(value);
+        } else if (!std::strcmp(arg, "--filter")) {
+            options.filter = value;
+        } else if (!std::strcmp(arg, "--zipf-exponent")) {
+            options.zipfExponent = std::atof(value);
+        } else if (!std::strcmp(arg, "--seed")) {
+            options.seed = std::strtoul(value, nullptr, 10);
+        } else if (!std::strcmp(arg, "--memory-limit")) {
+            options.memoryLimitMb = std::max(0L, std::atol(value));
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+// Allocation counting
+void *operator new(size_t size)
+{
+    allocationCount++;
+    void *p = std::malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    std::free(p);
+}
+
+int main(int argc, char *argv[])
+{
+    cStaticFlag dummy;
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        usage();
+        return 2;
+    }
+    
+    // Kernel without a network: only simulation time is used
+    CodeFragments::executeAll(CodeFragments::STARTUP);
+    SimTime::setScaleExp(-12);
+    cSimulation simulation("bench", new cNullEnvir(argc, argv, nullptr));  // Owns the environment
+    cSimulation::setActiveSimulation(&simulation);
+    
+    int failures = 0;
+    try {
+        failures = runAll(options);
+    } catch (std::exception& e) {
+        std::fprintf(stderr, "error: %s\n", e.what());
+        failures++;
+    }
+    
+    cSimulation::setActiveSimulation(nullptr);
+    CodeFragments::executeAll(CodeFragments::SHUTDOWN);
+    return failures ? 1 : 0;
+}
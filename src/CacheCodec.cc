@@ -0,0 +1,59 @@
+#include "CacheCodec.h"
+#include <cmath>
+
+// Constructors
+CacheCodec::CacheCodec()
+{
+    name = "none";
+    ratio = 1.0;
+    decompressionRate = 0.0;
+    decompressionOverhead = 0.0;
+}
+
+// Configuration
+void CacheCodec::configure(const std::string& codecName, double ratioOverride, double rateOverride, double overheadOverride)
+{
+    if (codecName == "none") {
+        ratio = 1.0;
+        decompressionRate = 0.0;
+        decompressionOverhead = 0.0;
+    } else if (codecName == "lz4") {
+        ratio = 4.0;  // Fast, moderate ratio
+        decompressionRate = 2e9;
+        decompressionOverhead = 2e-6;
+    } else if (codecName == "zstd") {
+        ratio = 6.0;  // Better ratio, slower to decode
+        decompressionRate = 8e8;
+        decompressionOverhead = 10e-6;
+    } else {
+        throw cRuntimeError("Unknown compressionCodec '%s' (expected none, lz4 or zstd)", codecName.c_str());
+    }
+    name = codecName;
+    
+    if (!isEnabled()) {
+        return;
+    }
+    if (ratioOverride < 0 || (ratioOverride > 0 && ratioOverride < 1) || rateOverride < 0) {
+        throw cRuntimeError("CacheCodec: compression ratio must be >= 1 and decompression rate positive");
+    }
+    if (ratioOverride > 0) ratio = ratioOverride;
+    if (rateOverride > 0) decompressionRate = rateOverride;
+    if (overheadOverride >= 0) decompressionOverhead = overheadOverride;
+}
+
+// Model
+size_t CacheCodec::compressedSize(size_t rawBytes) const
+{
+    if (!isEnabled()) {
+        return rawBytes;
+    }
+    return static_cast<size_t>(std::ceil(rawBytes / ratio));
+}
+
+double CacheCodec::decompressionTime(size_t rawBytes) const
+{
+    if (!isEnabled()) {
+        return 0.0;
+    }
+    return decompressionOverhead + rawBytes / decompressionRate;
+}
@@ -0,0 +1,43 @@
+#ifndef CACHECODEC_H
+#define CACHECODEC_H
+
+#include <omnetpp.h>
+#include <string>
+
+using namespace omnetpp;
+
+/**
+ * Modelled compression codec for cached response bodies
+ * Nothing is actually compressed: a codec is a compression ratio plus a
+ * decompression cost (fixed overhead and throughput), with defaults taken
+ * from typical LZ4/zstd figures on HTML. It turns body sizes into stored
+ * bytes and hit delays.
+ */
+class CacheCodec
+{
+private:
+    std::string name;
+    double ratio;  // Raw bytes per stored byte
+    double decompressionRate;  // Raw bytes per second
+    double decompressionOverhead;  // Seconds per decompression
+
+public:
+    // Constructors
+    CacheCodec();
+    
+    // Configuration: "none", "lz4" or "zstd"; 0 (negative for the overhead) keeps the codec default
+    void configure(const std::string& codecName, double ratioOverride = 0, double rateOverride = 0, double overheadOverride = -1);
+    
+    // Model
+    size_t compressedSize(size_t rawBytes) const;
+    double decompressionTime(size_t rawBytes) const;
+    
+    // Getters
+    bool isEnabled() const { return name != "none"; }
+    const std::string& getName() const { return name; }
+    double getRatio() const { return ratio; }
+    double getDecompressionRate() const { return decompressionRate; }
+    double getDecompressionOverhead() const { return decompressionOverhead; }
+};
+
+#endif // CACHECODEC_H
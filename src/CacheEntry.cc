@@ -5,16 +5,22 @@
 CacheEntry::CacheEntry()
 {
     resourceId = -1;
-    content = "";
+    content = nullptr;
     contentSize = 0;
     timestamp = SIMTIME_ZERO;
     ttl = 3600;  // Default 1 hour
     accessCount = 0;
     lastAccess = SIMTIME_ZERO;
     dirty = false;
+    provenance = DEMAND_FILLED;
+    hits = 0;
+    generationCost = 0.0;
+    storedSize = 0;
+    etag = 0;
+    lastModified = SIMTIME_ZERO;
 }
 
-CacheEntry::CacheEntry(int resId, const std::string& pageContent, int ttlSeconds)
+CacheEntry::CacheEntry(int resId, const PageContent& pageContent, int ttlSeconds)
 {
     resourceId = resId;
     setContent(pageContent);
@@ -23,6 +29,12 @@ CacheEntry::CacheEntry(int resId, const std::string& pageContent, int ttlSeconds
     accessCount = 1;
     lastAccess = timestamp;
     dirty = false;
+    provenance = DEMAND_FILLED;
+    hits = 0;
+    generationCost = 0.0;
+    storedSize = 0;
+    etag = 0;
+    lastModified = SIMTIME_ZERO;
 }
 
 CacheEntry::CacheEntry(const CacheEntry& other)
@@ -35,6 +47,12 @@ CacheEntry::CacheEntry(const CacheEntry& other)
     accessCount = other.accessCount;
     lastAccess = other.lastAccess;
     dirty = other.dirty;
+    provenance = other.provenance;
+    hits = other.hits;
+    generationCost = other.generationCost;
+    storedSize = other.storedSize;
+    etag = other.etag;
+    lastModified = other.lastModified;
 }
 
 // Destructor
@@ -56,15 +74,21 @@ CacheEntry& CacheEntry::operator=(const CacheEntry& other)
     accessCount = other.accessCount;
     lastAccess = other.lastAccess;
     dirty = other.dirty;
+    provenance = other.provenance;
+    hits = other.hits;
+    generationCost = other.generationCost;
+    storedSize = other.storedSize;
+    etag = other.etag;
+    lastModified = other.lastModified;
     
     return *this;
 }
 
 // Setters
-void CacheEntry::setContent(const std::string& pageContent)
+void CacheEntry::setContent(const PageContent& pageContent)
 {
-    content = pageContent;
-    contentSize = pageContent.length();
+    content = pageContent;  // Shares the body, no byte copy
+    contentSize = getPageContentSize(pageContent);
     dirty = true;  // Mark as dirty when content changes
 }
 
@@ -87,12 +111,13 @@ bool CacheEntry::isExpired() const
 
 bool CacheEntry::isValid() const
 {
-    return (resourceId >= 0 && !content.empty() && !isExpired());
+    return (resourceId >= 0 && contentSize > 0 && !isExpired());
 }
 
-void CacheEntry::refresh(const std::string& newContent, int newTtl)
+void CacheEntry::refresh(const PageContent& newContent, int newTtl)
 {
     setContent(newContent);
+    storedSize = 0;
     timestamp = simTime();
     if (newTtl >= 0) {
         ttl = newTtl;
@@ -117,7 +142,12 @@ std::string CacheEntry::toString() const
 
 size_t CacheEntry::getMemorySize() const
 {
-    return sizeof(CacheEntry) + content.capacity();
+    return isCompressed() ? sizeof(CacheEntry) + storedSize : getUncompressedMemorySize();
+}
+
+size_t CacheEntry::getUncompressedMemorySize() const
+{
+    return sizeof(CacheEntry) + contentSize;
 }
 
 // Comparison operators
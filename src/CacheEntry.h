@@ -3,29 +3,44 @@
 
 #include <omnetpp.h>
 #include <string>
+#include "PageContent.h"
 
 using namespace omnetpp;
 
 /**
  * Cache Entry structure for storing cached page content
  * Contains page content, metadata, and TTL information
+ * The body is a shared immutable handle, so copying an entry is cheap
  */
 class CacheEntry
 {
+public:
+    // How the entry got into the cache
+    enum Provenance {
+        DEMAND_FILLED = 0,  // Generated for a request
+        PREFETCHED = 1      // Generated ahead of time for a predicted request
+    };
+
 private:
     int resourceId;
-    std::string content;
+    PageContent content;
     int contentSize;
     simtime_t timestamp;
     int ttl;  // Time to live in seconds
     int accessCount;
     simtime_t lastAccess;
     bool dirty;  // Indicates if entry needs to be written back
-    
+    Provenance provenance;
+    int hits;  // Requests served from this entry
+    double generationCost;  // Server time spent producing the content (s)
+    size_t storedSize;  // Compressed body size, 0: stored uncompressed
+    uint32_t etag;  // Validator for conditional requests, 0 = none
+    simtime_t lastModified;
+
 public:
     // Constructors
     CacheEntry();
-    CacheEntry(int resId, const std::string& pageContent, int ttlSeconds = 3600);
+    CacheEntry(int resId, const PageContent& pageContent, int ttlSeconds = 3600);
     CacheEntry(const CacheEntry& other);
     
     // Destructor
@@ -36,30 +51,46 @@ public:
     
     // Getters
     int getResourceId() const { return resourceId; }
-    const std::string& getContent() const { return content; }
+    const std::string& getContent() const { return getPageContentText(content); }
+    const PageContent& getContentHandle() const { return content; }
     int getContentSize() const { return contentSize; }
     simtime_t getTimestamp() const { return timestamp; }
     int getTtl() const { return ttl; }
     int getAccessCount() const { return accessCount; }
     simtime_t getLastAccess() const { return lastAccess; }
     bool isDirty() const { return dirty; }
+    Provenance getProvenance() const { return provenance; }
+    bool isPrefetched() const { return provenance == PREFETCHED; }
+    int getHits() const { return hits; }
+    double getGenerationCost() const { return generationCost; }
+    bool isCompressed() const { return storedSize > 0; }
+    size_t getStoredSize() const { return storedSize; }
+    uint32_t getEtag() const { return etag; }
+    simtime_t getLastModified() const { return lastModified; }
     
     // Setters
     void setResourceId(int id) { resourceId = id; }
-    void setContent(const std::string& pageContent);
+    void setContent(const PageContent& pageContent);
+    void setContent(const std::string& pageContent) { setContent(makePageContent(pageContent)); }
     void setTimestamp(simtime_t t) { timestamp = t; }
     void setTtl(int ttlSeconds) { ttl = ttlSeconds; }
     void setDirty(bool d) { dirty = d; }
+    void setProvenance(Provenance p) { provenance = p; }
+    void setGenerationCost(double cost) { generationCost = cost; }
+    void setStoredSize(size_t compressedBytes) { storedSize = compressedBytes; }  // 0 stores the body uncompressed
+    void setValidators(uint32_t tag, simtime_t modified) { etag = tag; lastModified = modified; }
     
     // Cache operations
     void updateAccess();  // Update access count and last access time
+    int recordHit() { return ++hits; }  // Returns the hit count including this one
     bool isExpired() const;  // Check if entry has expired
     bool isValid() const;  // Check if entry is valid (not expired and has content)
-    void refresh(const std::string& newContent, int newTtl = -1);  // Refresh content
+    void refresh(const PageContent& newContent, int newTtl = -1);  // Refresh content
     
     // Utility methods
     std::string toString() const;
-    size_t getMemorySize() const;  // Get estimated memory usage
+    size_t getMemorySize() const;  // Get estimated memory usage (compressed body if compressed)
+    size_t getUncompressedMemorySize() const;
     
     // Comparison operators for sorting/searching
     bool operator==(const CacheEntry& other) const;
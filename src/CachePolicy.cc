@@ -0,0 +1,455 @@
+#include "CachePolicy.h"
+#include <algorithm>
+
+// FrequencySketch implementation
+FrequencySketch::FrequencySketch(int expectedEntries)
+{
+    size_t width = 16;
+    while (width < static_cast<size_t>(std::max(expectedEntries, 1)) * 2) {
+        width <<= 1;
+    }
+    widthMask = width - 1;
+    table.assign(DEPTH * width, 0);
+    additions = 0;
+    sampleSize = 10 * static_cast<long>(width);
+}
+
+void FrequencySketch::increment(int key)
+{
+    for (int row = 0; row < DEPTH; row++) {
+        uint8_t& counter = table[indexOf(key, row)];
+        if (counter < MAX_COUNT) {
+            counter++;
+        }
+    }
+    
+    if (++additions >= sampleSize) {
+        reset();
+    }
+}
+
+int FrequencySketch::estimate(int key) const
+{
+    int minimum = MAX_COUNT;
+    for (int row = 0; row < DEPTH; row++) {
+        minimum = std::min(minimum, static_cast<int>(table[indexOf(key, row)]));
+    }
+    return minimum;
+}
+
+void FrequencySketch::reset()
+{
+    for (auto& counter : table) {
+        counter >>= 1;
+    }
+    additions /= 2;
+}
+
+void FrequencySketch::clear()
+{
+    std::fill(table.begin(), table.end(), 0);
+    additions = 0;
+}
+
+size_t FrequencySketch::indexOf(int key, int row) const
+{
+    // splitmix64 finalizer, seeded per row
+    uint64_t h = static_cast<uint64_t>(static_cast<uint32_t>(key)) + 0x9E3779B97F4A7C15ULL * (row + 1);
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+    return row * (widthMask + 1) + (h & widthMask);
+}
+
+// EvictionPolicy factory
+EvictionPolicy* EvictionPolicy::create(const std::string& name, int capacity)
+{
+    if (name == "lru") return nullptr;  // Built into ResponseCache
+    if (name == "fifo") return new FifoPolicy();
+    if (name == "lfu") return new LfuPolicy();
+    if (name == "arc") return new ArcPolicy(capacity);
+    if (name == "tinylfu") return new TinyLfuPolicy(capacity);
+    if (name == "gds") return new GreedyDualSizePolicy();
+    
+    throw cRuntimeError("Unknown eviction policy '%s' (expected lru, lfu, fifo, arc, tinylfu or gds)", name.c_str());
+}
+
+// FifoPolicy implementation
+void FifoPolicy::onInsert(int resourceId)
+{
+    if (positions.find(resourceId) != positions.end()) {
+        return;  // Replacing content keeps the original insertion order
+    }
+    positions[resourceId] = queue.insert(queue.end(), resourceId);
+}
+
+void FifoPolicy::onRemove(int resourceId)
+{
+    auto it = positions.find(resourceId);
+    if (it != positions.end()) {
+        queue.erase(it->second);
+        positions.erase(it);
+    }
+}
+
+int FifoPolicy::selectVictim(int /*incomingId*/) const
+{
+    return queue.empty() ? -1 : queue.front();
+}
+
+void FifoPolicy::clear()
+{
+    queue.clear();
+    positions.clear();
+}
+
+// LfuPolicy implementation
+void LfuPolicy::onInsert(int resourceId)
+{
+    if (keys.find(resourceId) != keys.end()) {
+        onAccess(resourceId);
+        return;
+    }
+    place(resourceId, 1);
+}
+
+void LfuPolicy::onAccess(int resourceId)
+{
+    auto it = keys.find(resourceId);
+    if (it == keys.end()) {
+        return;
+    }
+    
+    KeyState state = it->second;
+    unplace(resourceId, state);
+    place(resourceId, state.frequency + 1);
+}
+
+void LfuPolicy::onRemove(int resourceId)
+{
+    auto it = keys.find(resourceId);
+    if (it != keys.end()) {
+        unplace(resourceId, it->second);
+        keys.erase(it);
+    }
+}
+
+int LfuPolicy::selectVictim(int /*incomingId*/) const
+{
+    if (buckets.empty()) {
+        return -1;
+    }
+    return buckets.begin()->second.back();  // Least frequent, least recent among those
+}
+
+void LfuPolicy::clear()
+{
+    buckets.clear();
+    keys.clear();
+}
+
+void LfuPolicy::place(int resourceId, long frequency)
+{
+    std::list<int>& bucket = buckets[frequency];
+    bucket.push_front(resourceId);
+    keys[resourceId] = KeyState{frequency, bucket.begin()};
+}
+
+void LfuPolicy::unplace(int /*resourceId*/, const KeyState& state)
+{
+    auto bucketIt = buckets.find(state.frequency);
+    bucketIt->second.erase(state.position);
+    if (bucketIt->second.empty()) {
+        buckets.erase(bucketIt);
+    }
+}
+
+// ArcPolicy implementation
+ArcPolicy::ArcPolicy(int capacity)
+{
+    this->capacity = std::max(capacity, 1);
+    targetT1 = 0.0;
+}
+
+void ArcPolicy::onInsert(int resourceId)
+{
+    auto it = keys.find(resourceId);
+    if (it == keys.end()) {
+        // Complete miss: new entries start in T1
+        lists[T1].push_front(resourceId);
+        keys[resourceId] = KeyState{T1, lists[T1].begin()};
+    } else if (it->second.segment == B1) {
+        // Ghost hit in B1: recency was undervalued, grow T1 target
+        double delta = std::max(1.0, (double)lists[B2].size() / lists[B1].size());
+        targetT1 = std::min((double)capacity, targetT1 + delta);
+        moveTo(resourceId, T2);
+    } else if (it->second.segment == B2) {
+        // Ghost hit in B2: frequency was undervalued, shrink T1 target
+        double delta = std::max(1.0, (double)lists[B1].size() / lists[B2].size());
+        targetT1 = std::max(0.0, targetT1 - delta);
+        moveTo(resourceId, T2);
+    } else {
+        onAccess(resourceId);  // Content replaced for a resident entry
+    }
+    
+    trimGhosts();
+}
+
+void ArcPolicy::onAccess(int resourceId)
+{
+    auto it = keys.find(resourceId);
+    if (it != keys.end() && (it->second.segment == T1 || it->second.segment == T2)) {
+        moveTo(resourceId, T2);
+    }
+}
+
+void ArcPolicy::onRemove(int resourceId)
+{
+    // Expired or erased entries leave no ghost: they say nothing about the policy
+    auto it = keys.find(resourceId);
+    if (it != keys.end()) {
+        lists[it->second.segment].erase(it->second.position);
+        keys.erase(it);
+    }
+}
+
+void ArcPolicy::onEvict(int resourceId)
+{
+    auto it = keys.find(resourceId);
+    if (it == keys.end()) {
+        return;
+    }
+    
+    if (it->second.segment == T1) {
+        moveTo(resourceId, B1);
+    } else if (it->second.segment == T2) {
+        moveTo(resourceId, B2);
+    }
+    trimGhosts();
+}
+
+int ArcPolicy::selectVictim(int incomingId) const
+{
+    // REPLACE(x, p) from the ARC paper
+    int sizeT1 = lists[T1].size();
+    auto it = keys.find(incomingId);
+    bool incomingInB2 = (it != keys.end() && it->second.segment == B2);
+    
+    if (sizeT1 > 0 && (sizeT1 > targetT1 || (incomingInB2 && sizeT1 == (int)targetT1))) {
+        return lists[T1].back();
+    }
+    if (!lists[T2].empty()) {
+        return lists[T2].back();
+    }
+    return lists[T1].empty() ? -1 : lists[T1].back();
+}
+
+void ArcPolicy::clear()
+{
+    for (auto& list : lists) {
+        list.clear();
+    }
+    keys.clear();
+    targetT1 = 0.0;
+}
+
+void ArcPolicy::moveTo(int resourceId, Segment segment)
+{
+    KeyState& state = keys[resourceId];
+    lists[state.segment].erase(state.position);
+    lists[segment].push_front(resourceId);
+    state.segment = segment;
+    state.position = lists[segment].begin();
+}
+
+void ArcPolicy::trimGhosts()
+{
+    while (lists[T1].size() + lists[B1].size() > static_cast<size_t>(capacity) && !lists[B1].empty()) {
+        keys.erase(lists[B1].back());
+        lists[B1].pop_back();
+    }
+    
+    size_t total = lists[T1].size() + lists[T2].size() + lists[B1].size() + lists[B2].size();
+    while (total > static_cast<size_t>(2 * capacity) && !lists[B2].empty()) {
+        keys.erase(lists[B2].back());
+        lists[B2].pop_back();
+        total--;
+    }
+}
+
+// TinyLfuPolicy implementation
+TinyLfuPolicy::TinyLfuPolicy(int capacity) : sketch(capacity)
+{
+    capacity = std::max(capacity, 1);
+    windowCapacity = std::max(1, capacity / 100);  // 1% admission window
+    int mainCapacity = std::max(capacity - windowCapacity, 0);
+    protectedCapacity = static_cast<int>(mainCapacity * 0.8);  // 80% of main is protected
+}
+
+void TinyLfuPolicy::onInsert(int resourceId)
+{
+    if (keys.find(resourceId) != keys.end()) {
+        onAccess(resourceId);
+        return;
+    }
+    
+    lists[WINDOW].push_front(resourceId);
+    keys[resourceId] = KeyState{WINDOW, lists[WINDOW].begin()};
+    
+    // Window overflow moves its LRU entry to probation (the cache already made room)
+    while (lists[WINDOW].size() > static_cast<size_t>(windowCapacity)) {
+        moveTo(lists[WINDOW].back(), PROBATION);
+    }
+}
+
+void TinyLfuPolicy::onAccess(int resourceId)
+{
+    auto it = keys.find(resourceId);
+    if (it == keys.end()) {
+        return;
+    }
+    
+    if (it->second.segment == PROBATION) {
+        moveTo(resourceId, PROTECTED);
+        while (lists[PROTECTED].size() > static_cast<size_t>(protectedCapacity) && !lists[PROTECTED].empty()) {
+            moveTo(lists[PROTECTED].back(), PROBATION);
+        }
+    } else {
+        moveTo(resourceId, it->second.segment);  // Refresh position within its segment
+    }
+}
+
+void TinyLfuPolicy::onRemove(int resourceId)
+{
+    auto it = keys.find(resourceId);
+    if (it != keys.end()) {
+        lists[it->second.segment].erase(it->second.position);
+        keys.erase(it);
+    }
+}
+
+int TinyLfuPolicy::selectVictim(int /*incomingId*/) const
+{
+    int mainVictim = -1;
+    if (!lists[PROBATION].empty()) {
+        mainVictim = lists[PROBATION].back();
+    } else if (!lists[PROTECTED].empty()) {
+        mainVictim = lists[PROTECTED].back();
+    }
+    
+    // The incoming entry pushes the window's LRU entry out: it competes with the main victim
+    if (!lists[WINDOW].empty() && lists[WINDOW].size() >= static_cast<size_t>(windowCapacity)) {
+        int candidate = lists[WINDOW].back();
+        if (mainVictim < 0) {
+            return candidate;
+        }
+        return (sketch.estimate(candidate) > sketch.estimate(mainVictim)) ? mainVictim : candidate;
+    }
+    
+    if (mainVictim >= 0) {
+        return mainVictim;
+    }
+    return lists[WINDOW].empty() ? -1 : lists[WINDOW].back();
+}
+
+void TinyLfuPolicy::clear()
+{
+    for (auto& list : lists) {
+        list.clear();
+    }
+    keys.clear();
+    sketch.clear();
+}
+
+void TinyLfuPolicy::moveTo(int resourceId, Segment segment)
+{
+    KeyState& state = keys[resourceId];
+    lists[state.segment].erase(state.position);
+    lists[segment].push_front(resourceId);
+    state.segment = segment;
+    state.position = lists[segment].begin();
+}
+
+// GreedyDualSizePolicy implementation
+void GreedyDualSizePolicy::setEntryCost(int resourceId, size_t bytes, double cost)
+{
+    double costPerByte = ((cost > 0) ? cost : 1.0) / std::max<size_t>(bytes, 1);
+    auto it = keys.find(resourceId);
+    if (it == keys.end()) {
+        keys[resourceId] = KeyState{-1.0, costPerByte};  // Placed by onInsert
+        return;
+    }
+    
+    // Tracked entry changed size: revalue in place
+    if (it->second.value >= 0) {
+        order.erase(std::make_pair(it->second.value, resourceId));
+    }
+    it->second.costPerByte = costPerByte;
+    revalue(resourceId, it->second);
+}
+
+void GreedyDualSizePolicy::onInsert(int resourceId)
+{
+    auto it = keys.find(resourceId);
+    if (it == keys.end()) {
+        it = keys.emplace(resourceId, KeyState{-1.0, 1.0}).first;  // No setEntryCost: unit cost and size
+    }
+    if (it->second.value >= 0) {
+        order.erase(std::make_pair(it->second.value, resourceId));  // Replaced entry
+    }
+    revalue(resourceId, it->second);
+}
+
+void GreedyDualSizePolicy::onAccess(int resourceId)
+{
+    auto it = keys.find(resourceId);
+    if (it != keys.end()) {
+        order.erase(std::make_pair(it->second.value, resourceId));
+        revalue(resourceId, it->second);
+    }
+}
+
+void GreedyDualSizePolicy::onRemove(int resourceId)
+{
+    auto it = keys.find(resourceId);
+    if (it != keys.end()) {
+        order.erase(std::make_pair(it->second.value, resourceId));
+        keys.erase(it);
+    }
+}
+
+void GreedyDualSizePolicy::onEvict(int resourceId)
+{
+    auto it = keys.find(resourceId);
+    if (it != keys.end()) {
+        inflation = it->second.value;  // Everything left is worth at least the victim
+    }
+    onRemove(resourceId);
+}
+
+int GreedyDualSizePolicy::selectVictim(int /*incomingId*/) const
+{
+    return order.empty() ? -1 : order.begin()->second;
+}
+
+void GreedyDualSizePolicy::clear()
+{
+    order.clear();
+    keys.clear();
+    inflation = 0.0;
+}
+
+void GreedyDualSizePolicy::revalue(int resourceId, KeyState& state)
+{
+    state.value = inflation + state.costPerByte;
+    order.insert(std::make_pair(state.value, resourceId));
+}
+
+// AdmissionFilter implementation
+bool AdmissionFilter::admit(int candidateId, int victimId, double weight) const
+{
+    if (victimId < 0) {
+        return true;  // Nothing would be displaced
+    }
+    return weight * sketch.estimate(candidateId) >= sketch.estimate(victimId);
+}
@@ -0,0 +1,252 @@
+#ifndef CACHEPOLICY_H
+#define CACHEPOLICY_H
+
+#include <omnetpp.h>
+#include <list>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+using namespace omnetpp;
+
+/**
+ * Count-Min sketch of request frequencies with periodic aging
+ * 4-bit style saturating counters; all counters are halved every
+ * sampleSize increments so old popularity fades out
+ */
+class FrequencySketch
+{
+private:
+    std::vector<uint8_t> table;  // depth rows of width counters
+    size_t widthMask;
+    long additions;
+    long sampleSize;
+    
+    static const int DEPTH = 4;
+    static const uint8_t MAX_COUNT = 15;
+
+public:
+    FrequencySketch(int expectedEntries = 64);
+    
+    void increment(int key);
+    int estimate(int key) const;
+    void reset();  // Halve all counters
+    void clear();
+
+private:
+    size_t indexOf(int key, int row) const;
+};
+
+/**
+ * Eviction policy interface for ResponseCache
+ * Policies keep their own bookkeeping keyed by resourceId; the cache
+ * notifies them of every insert, hit, removal and demand request and asks
+ * them for a victim when it is full. Plain LRU needs no policy object:
+ * the cache's own intrusive recency list is used instead.
+ */
+class EvictionPolicy
+{
+public:
+    virtual ~EvictionPolicy() {}
+    
+    virtual const char* getName() const = 0;
+    
+    // Notifications from the cache
+    virtual void onRequest(int /*resourceId*/) {}  // Every demand request (hit or miss)
+    virtual void setEntryCost(int /*resourceId*/, size_t /*bytes*/, double /*cost*/) {}  // Before onInsert, or when an entry is resized
+    virtual void onInsert(int resourceId) = 0;
+    virtual void onAccess(int resourceId) = 0;  // Cache hit
+    virtual void onRemove(int resourceId) = 0;  // Expired or erased
+    virtual void onEvict(int resourceId) { onRemove(resourceId); }  // Chosen victim removed
+    
+    // Victim selection, -1 if the policy tracks nothing
+    virtual int selectVictim(int incomingId) const = 0;
+    
+    virtual void clear() = 0;
+    
+    // Factory: returns nullptr for "lru" (built-in), throws on unknown names
+    static EvictionPolicy* create(const std::string& name, int capacity);
+};
+
+/**
+ * FIFO: evict in insertion order, hits do not change the order
+ */
+class FifoPolicy : public EvictionPolicy
+{
+private:
+    std::list<int> queue;  // Oldest at front
+    std::unordered_map<int, std::list<int>::iterator> positions;
+
+public:
+    virtual const char* getName() const override { return "fifo"; }
+    virtual void onInsert(int resourceId) override;
+    virtual void onAccess(int /*resourceId*/) override {}
+    virtual void onRemove(int resourceId) override;
+    virtual int selectVictim(int incomingId) const override;
+    virtual void clear() override;
+};
+
+/**
+ * LFU: evict the least frequently used entry, LRU among equal counts
+ * Frequency buckets are kept in an ordered map, so updates are O(log F)
+ */
+class LfuPolicy : public EvictionPolicy
+{
+private:
+    struct KeyState {
+        long frequency;
+        std::list<int>::iterator position;
+    };
+    
+    std::map<long, std::list<int>> buckets;  // frequency -> keys, MRU at front
+    std::unordered_map<int, KeyState> keys;
+
+public:
+    virtual const char* getName() const override { return "lfu"; }
+    virtual void onInsert(int resourceId) override;
+    virtual void onAccess(int resourceId) override;
+    virtual void onRemove(int resourceId) override;
+    virtual int selectVictim(int incomingId) const override;
+    virtual void clear() override;
+
+private:
+    void place(int resourceId, long frequency);
+    void unplace(int resourceId, const KeyState& state);
+};
+
+/**
+ * ARC (Adaptive Replacement Cache, Megiddo & Modha)
+ * T1 holds entries seen once, T2 entries seen at least twice; the ghost
+ * lists B1/B2 remember recent victims and steer the target size p of T1
+ */
+class ArcPolicy : public EvictionPolicy
+{
+private:
+    enum Segment { T1, T2, B1, B2 };
+    
+    struct KeyState {
+        Segment segment;
+        std::list<int>::iterator position;
+    };
+    
+    std::list<int> lists[4];  // MRU at front
+    std::unordered_map<int, KeyState> keys;
+    int capacity;
+    double targetT1;  // p in the ARC paper
+
+public:
+    ArcPolicy(int capacity);
+    
+    virtual const char* getName() const override { return "arc"; }
+    virtual void onInsert(int resourceId) override;
+    virtual void onAccess(int resourceId) override;
+    virtual void onRemove(int resourceId) override;
+    virtual void onEvict(int resourceId) override;
+    virtual int selectVictim(int incomingId) const override;
+    virtual void clear() override;
+    
+    double getTargetT1() const { return targetT1; }
+
+private:
+    void moveTo(int resourceId, Segment segment);
+    void trimGhosts();
+};
+
+/**
+ * W-TinyLFU (Einziger et al.)
+ * A small LRU window admits new entries; its victim only enters the
+ * segmented-LRU main area if the frequency sketch rates it higher than
+ * the main area's own victim
+ */
+class TinyLfuPolicy : public EvictionPolicy
+{
+private:
+    enum Segment { WINDOW, PROBATION, PROTECTED };
+    
+    struct KeyState {
+        Segment segment;
+        std::list<int>::iterator position;
+    };
+    
+    std::list<int> lists[3];  // MRU at front
+    std::unordered_map<int, KeyState> keys;
+    FrequencySketch sketch;
+    int windowCapacity;
+    int protectedCapacity;
+
+public:
+    TinyLfuPolicy(int capacity);
+    
+    virtual const char* getName() const override { return "tinylfu"; }
+    virtual void onRequest(int resourceId) override { sketch.increment(resourceId); }
+    virtual void onInsert(int resourceId) override;
+    virtual void onAccess(int resourceId) override;
+    virtual void onRemove(int resourceId) override;
+    virtual int selectVictim(int incomingId) const override;
+    virtual void clear() override;
+
+private:
+    void moveTo(int resourceId, Segment segment);
+};
+
+/**
+ * GreedyDual-Size (Cao & Irani)
+ * Every entry is worth H = L + cost / size; the entry with the lowest H is
+ * evicted and the inflation value L rises to it, so entries that stop being
+ * hit age out. Small, expensive pages are kept over large, cheap ones.
+ * Entries without a known generation cost cost 1 (GDS(1), favours hit ratio).
+ */
+class GreedyDualSizePolicy : public EvictionPolicy
+{
+private:
+    struct KeyState {
+        double value;  // H, negative until placed
+        double costPerByte;
+    };
+    
+    std::set<std::pair<double, int>> order;  // (H, resourceId), victim first
+    std::unordered_map<int, KeyState> keys;
+    double inflation;  // L
+
+public:
+    GreedyDualSizePolicy() : inflation(0.0) {}
+    
+    virtual const char* getName() const override { return "gds"; }
+    virtual void setEntryCost(int resourceId, size_t bytes, double cost) override;
+    virtual void onInsert(int resourceId) override;
+    virtual void onAccess(int resourceId) override;
+    virtual void onRemove(int resourceId) override;
+    virtual void onEvict(int resourceId) override;
+    virtual int selectVictim(int incomingId) const override;
+    virtual void clear() override;
+    
+    double getInflation() const { return inflation; }
+
+private:
+    void revalue(int resourceId, KeyState& state);  // H = L + cost / size
+};
+
+/**
+ * Frequency-aware admission filter (TinyLFU admission)
+ * A candidate may only replace a victim if its demand frequency, weighted
+ * by its prediction probability for pre-cached pages, is at least the
+ * victim's
+ */
+class AdmissionFilter
+{
+private:
+    FrequencySketch sketch;
+
+public:
+    AdmissionFilter(int capacity) : sketch(capacity) {}
+    
+    void recordRequest(int resourceId) { sketch.increment(resourceId); }
+    bool admit(int candidateId, int victimId, double weight = 1.0) const;
+    int estimate(int resourceId) const { return sketch.estimate(resourceId); }
+    void clear() { sketch.clear(); }
+};
+
+#endif // CACHEPOLICY_H
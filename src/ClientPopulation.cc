@@ -0,0 +1,352 @@
+#include <omnetpp.h>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <functional>
+#include <cstdint>
+#include "HttpMessage.h"
+#include "RandomStream.h"
+#include "TransmissionQueue.h"
+#include "Visuals.h"
+
+using namespace omnetpp;
+
+/**
+ * Aggregated client population
+ * Simulates numUsers virtual users with the same behavior as HttpClient
+ * (80% home→login→dashboard pattern, 20% random page, 1-2s think time)
+ * from one module and one gate pair. User state is kept as parallel arrays
+ * indexed by user, and one min-heap of wake-up times drives all users with
+ * a single self-message. Users get clientIds firstClientId .. firstClientId+numUsers-1,
+ * which must not overlap with other clients of the same server.
+ * There is no browser cache: every navigation is a request, pushed pages are dropped.
+ */
+class ClientPopulation : public cSimpleModule
+{
+public:
+    // Web page definitions (matching server)
+    enum WebPage {
+        HOME = 0,
+        LOGIN = 1,
+        DASHBOARD = 2,
+        PROFILE = 3,
+        SETTINGS = 4,
+        LOGOUT = 5
+    };
+
+private:
+    // Wake-up record; every user is either in the heap (thinking) or waiting for a response
+    struct Wakeup {
+        simtime_t time;
+        int user;
+        
+        bool operator>(const Wakeup& other) const { return time > other.time; }
+    };
+    
+    // Configuration
+    int numUsers;
+    int firstClientId;
+    bool visualize;          // Display-string updates (configurable)
+    bool verbose;            // Per-request log lines (configurable)
+    
+    // Per-user state (structure of arrays, indexed by user)
+    std::vector<uint8_t> currentPage;
+    std::vector<uint8_t> patternStep;  // Position in the predictable pattern
+    std::vector<int> requestCounter;  // Id of the user's latest request
+    std::vector<simtime_t> sentAt;  // Send time of the outstanding request
+    
+    // Pattern control
+    std::vector<int> predictablePattern;  // home→login→dashboard cycle
+    double patternProbability;            // 80% predictable, 20% random
+    
+    // Random number generation: substream per user and navigation, so one user's
+    // draws do not depend on the order in which other users' responses arrive
+    RandomStream pageChoiceRng;
+    RandomStream thinkTimeRng;
+    std::uniform_real_distribution<double> patternChoice;
+    std::uniform_real_distribution<double> thinkTimeDistribution;
+    std::uniform_int_distribution<int> randomPageChoice;
+    
+    // Event calendar: users sorted by wake-up time, earliest at front
+    std::vector<Wakeup> wakeups;
+    cMessage *wakeupTimer;  // Scheduled at wakeups.front().time
+    
+    // Output link
+    TransmissionQueue txQueue;
+    WireFormat requestFormat;  // Header bytes and TCP framing (configurable)
+    
+    // Statistics
+    long requestsSent;
+    long responsesReceived;
+    long patternFollowed;
+    long randomChoices;
+    long pushesDropped;
+    double responseTimeSum;
+    
+    // Statistics signals
+    simsignal_t requestSentSignal;
+    simsignal_t responseReceivedSignal;
+    simsignal_t responseTimeSignal;
+    simsignal_t timeToFirstByteSignal;
+    simsignal_t patternFollowedSignal;
+    simsignal_t randomChoiceSignal;
+
+protected:
+    virtual void initialize() override;
+    virtual void handleMessage(cMessage *msg) override;
+    virtual void finish() override;
+    
+    // Helper methods
+    virtual void wakeDueUsers();
+    virtual void scheduleWakeup(int user, simtime_t time);
+    virtual int selectNextPage(int user);
+    virtual void sendHttpRequest(int user, int pageId);
+    virtual void handleHttpResponse(HttpResponse *response);
+    virtual void updateDisplay();
+    uint64_t drawId(int user) const { return (static_cast<uint64_t>(user) << 32) | static_cast<uint32_t>(requestCounter[user]); }
+};
+
+Define_Module(ClientPopulation);
+
+void ClientPopulation::initialize()
+{
+    // Initialize population - READ FROM PARAMETERS
+    numUsers = par("numUsers").intValue();
+    firstClientId = par("firstClientId").intValue();
+    visualize = par("visualize").boolValue();
+    verbose = par("verbose").boolValue();
+    if (numUsers < 0 || firstClientId < 0) {
+        throw cRuntimeError("numUsers and firstClientId must not be negative");
+    }
+    
+    currentPage.assign(numUsers, HOME);  // Everyone starts at the home page
+    patternStep.assign(numUsers, 0);
+    requestCounter.assign(numUsers, 0);
+    sentAt.assign(numUsers, SIMTIME_ZERO);
+    
+    // Setup predictable pattern: home→login→dashboard cycle
+    predictablePattern = {HOME, LOGIN, DASHBOARD};
+    patternProbability = 0.8;  // 80% predictable pattern
+    
+    // Initialize random number generators
+    pageChoiceRng.seed(getRNG(par("pageChoiceRng").intValue()));  // READ FROM PARAMETERS
+    thinkTimeRng.seed(getRNG(par("thinkTimeRng").intValue()));
+    patternChoice = std::uniform_real_distribution<double>(0.0, 1.0);
+    thinkTimeDistribution = std::uniform_real_distribution<double>(1.0, 2.0);  // 1-2 seconds
+    int numPages = par("numPages").intValue();  // READ FROM PARAMETERS: size of the server's catalog
+    if (numPages <= 0) {
+        throw cRuntimeError("numPages must be positive");
+    }
+    randomPageChoice = std::uniform_int_distribution<int>(HOME, numPages - 1);  // All pages
+    
+    // Register statistics signals
+    requestSentSignal = registerSignal("requestSent");
+    responseReceivedSignal = registerSignal("responseReceived");
+    responseTimeSignal = registerSignal("responseTime");
+    timeToFirstByteSignal = registerSignal("timeToFirstByte");
+    patternFollowedSignal = registerSignal("patternFollowed");
+    randomChoiceSignal = registerSignal("randomChoice");
+    requestsSent = 0;
+    responsesReceived = 0;
+    patternFollowed = 0;
+    randomChoices = 0;
+    pushesDropped = 0;
+    responseTimeSum = 0.0;
+    
+    // Initialize output link - READ FROM PARAMETERS
+    requestFormat.headerBytes = par("requestHeaderBytes").intValue();
+    requestFormat.mss = par("mss").intValue();
+    requestFormat.segmentOverhead = par("segmentOverhead").intValue();
+    if (requestFormat.mss <= 0) {
+        throw cRuntimeError("mss must be positive");
+    }
+    txQueue.init(this, gate("out"), registerSignal("txQueueingDelay"));
+    
+    // First request of every user after a small random delay, like HttpClient
+    wakeupTimer = new cMessage("wakeup");
+    wakeups.reserve(numUsers);
+    for (int user = 0; user < numUsers; user++) {
+        wakeups.push_back(Wakeup{simTime() + thinkTimeRng.substream(drawId(user)).uniform(0.1, 0.5), user});
+    }
+    std::make_heap(wakeups.begin(), wakeups.end(), std::greater<Wakeup>());
+    if (!wakeups.empty()) {
+        scheduleAt(wakeups.front().time, wakeupTimer);
+    }
+    
+    updateDisplay();
+    
+    EV << "ClientPopulation initialized with " << numUsers << " users, clientIds "
+       << firstClientId << ".." << firstClientId + numUsers - 1 << endl;
+}
+
+void ClientPopulation::handleMessage(cMessage *msg)
+{
+    if (msg->isSelfMessage()) {
+        if (msg == wakeupTimer) {
+            wakeDueUsers();
+        } else if (TransmissionQueue::isTimer(msg)) {
+            TransmissionQueue::handleTimer(msg);
+        }
+    } else {
+        // Handle HTTP response
+        HttpResponse *response = dynamic_cast<HttpResponse*>(msg);
+        if (response) {
+            handleHttpResponse(response);
+        } else {
+            EV << "ERROR: Received non-HttpResponse message: " << msg->getClassName() << endl;
+        }
+        delete msg;
+    }
+}
+
+void ClientPopulation::wakeDueUsers()
+{
+    // Every user whose think time is over navigates to its next page
+    simtime_t now = simTime();
+    while (!wakeups.empty() && wakeups.front().time <= now) {
+        int user = wakeups.front().user;
+        std::pop_heap(wakeups.begin(), wakeups.end(), std::greater<Wakeup>());
+        wakeups.pop_back();
+        
+        int nextPage = selectNextPage(user);
+        sendHttpRequest(user, nextPage);
+        currentPage[user] = nextPage;
+    }
+    
+    if (!wakeups.empty()) {
+        scheduleAt(wakeups.front().time, wakeupTimer);
+    }
+    updateDisplay();
+}
+
+void ClientPopulation::scheduleWakeup(int user, simtime_t time)
+{
+    wakeups.push_back(Wakeup{time, user});
+    std::push_heap(wakeups.begin(), wakeups.end(), std::greater<Wakeup>());
+    
+    // The timer always fires for the earliest wake-up
+    if (!wakeupTimer->isScheduled()) {
+        scheduleAt(time, wakeupTimer);
+    } else if (time < wakeupTimer->getArrivalTime()) {
+        cancelEvent(wakeupTimer);
+        scheduleAt(time, wakeupTimer);
+    }
+}
+
+int ClientPopulation::selectNextPage(int user)
+{
+    // Decide whether to follow predictable pattern (80%) or choose randomly (20%)
+    RandomStream userRng = pageChoiceRng.substream(drawId(user));
+    if (patternChoice(userRng) < patternProbability) {
+        int step = patternStep[user];
+        patternStep[user] = (step + 1) % predictablePattern.size();
+        patternFollowed++;
+        emit(patternFollowedSignal, 1);
+        return predictablePattern[step];
+    } else {
+        randomChoices++;
+        emit(randomChoiceSignal, 1);
+        return randomPageChoice(userRng);
+    }
+}
+
+void ClientPopulation::sendHttpRequest(int user, int pageId)
+{
+    int clientId = firstClientId + user;
+    int requestId = ++requestCounter[user];
+    requestsSent++;
+    
+    HttpRequest *request = new HttpRequest("HttpRequest");
+    request->setRequestId(requestId);
+    request->setClientId(clientId);
+    request->setResourceId(pageId);
+    request->setFromPage(currentPage[user]);  // Track navigation pattern
+    request->setTimestamp(simTime());
+    request->setByteLength(requestFormat.messageBytes(request->getUrl().length()));
+    
+    sentAt[user] = simTime();
+    txQueue.send(request);
+    
+    emit(requestSentSignal, requestsSent);
+    
+    LOG_EV << "User " << clientId << " sent request " << requestId
+       << " for page " << pageId << " (from page " << (int)currentPage[user] << ")" << endl;
+}
+
+void ClientPopulation::handleHttpResponse(HttpResponse *response)
+{
+    // Pushed pages have nowhere to go without a browser cache
+    if (response->isPushed()) {
+        if (response->isLastChunk()) {
+            pushesDropped++;
+        }
+        return;
+    }
+    
+    int user = response->getClientId() - firstClientId;
+    if (user < 0 || user >= numUsers || response->getRequestId() != requestCounter[user]) {
+        EV << "WARNING: Received response for unknown request " << response->getRequestId()
+           << " of client " << response->getClientId() << endl;
+        return;
+    }
+    
+    // The first chunk (or the whole response) marks the first byte
+    simtime_t elapsed = simTime() - sentAt[user];
+    if (response->getChunkIndex() == 0) {
+        emit(timeToFirstByteSignal, elapsed.dbl());
+    }
+    
+    // A chunked response is complete with its last chunk
+    if (!response->isLastChunk()) {
+        return;
+    }
+    
+    responsesReceived++;
+    responseTimeSum += elapsed.dbl();
+    emit(responseTimeSignal, elapsed.dbl());
+    emit(responseReceivedSignal, responsesReceived);
+    
+    LOG_EV << "User " << response->getClientId() << " received response for request " << response->getRequestId()
+       << " (page " << response->getResourceId() << ") - Response time: " << elapsed << "s" << endl;
+    
+    // Think time (1-2 seconds) before the user's next navigation
+    RandomStream userRng = thinkTimeRng.substream(drawId(user));
+    scheduleWakeup(user, simTime() + thinkTimeDistribution(userRng));
+}
+
+void ClientPopulation::updateDisplay()
+{
+    IF_VISUALIZE {
+        int waiting = numUsers - (int)wakeups.size();
+        std::string text = std::to_string(numUsers) + " users\n" + std::to_string(waiting) + " waiting\n"
+                           + std::to_string(requestsSent) + " requests";
+        getDisplayString().setTagArg("t", 0, text.c_str());
+    }
+}
+
+void ClientPopulation::finish()
+{
+    EV << "ClientPopulation statistics:" << endl;
+    EV << "  Users: " << numUsers << endl;
+    EV << "  Total requests sent: " << requestsSent << endl;
+    EV << "  Total responses received: " << responsesReceived << endl;
+    EV << "  Response rate: "
+       << (requestsSent > 0 ? (double)responsesReceived / requestsSent * 100 : 0) << "%" << endl;
+    
+    // Record scalar statistics (same names as HttpClient, summed over all users)
+    recordScalar("numUsers", numUsers);
+    recordScalar("requestsSent", requestsSent);
+    recordScalar("responsesReceived", responsesReceived);
+    recordScalar("responseRate", requestsSent > 0 ? (double)responsesReceived / requestsSent : 0);
+    recordScalar("avgResponseTime", responsesReceived > 0 ? responseTimeSum / responsesReceived : 0.0);
+    recordScalar("patternFollowed", patternFollowed);
+    recordScalar("randomChoices", randomChoices);
+    if (pushesDropped > 0) {
+        recordScalar("pushesDropped", pushesDropped);
+    }
+    
+    // Clean up
+    cancelAndDelete(wakeupTimer);
+    txQueue.clear();
+}
@@ -0,0 +1,50 @@
+#include "ConsistentHashRing.h"
+#include <algorithm>
+
+// Constructors
+ConsistentHashRing::ConsistentHashRing(int pointsPerNode)
+{
+    virtualNodes = pointsPerNode;
+    numNodes = 0;
+}
+
+// Ring construction
+void ConsistentHashRing::build(int nodes)
+{
+    numNodes = nodes;
+    points.clear();
+    points.reserve(static_cast<size_t>(nodes) * virtualNodes);
+    
+    for (int node = 0; node < nodes; node++) {
+        for (int replica = 0; replica < virtualNodes; replica++) {
+            uint64_t position = hash((static_cast<uint64_t>(node) << 32) | static_cast<uint32_t>(replica));
+            points.push_back(std::make_pair(position, node));
+        }
+    }
+    std::sort(points.begin(), points.end());
+}
+
+// Lookup
+int ConsistentHashRing::lookup(int key) const
+{
+    if (points.empty()) {
+        return -1;
+    }
+    
+    // Keys hash into a different stream than ring points (high bit set)
+    uint64_t position = hash(static_cast<uint32_t>(key) | (1ULL << 63));
+    auto it = std::lower_bound(points.begin(), points.end(), std::make_pair(position, -1));
+    if (it == points.end()) {
+        it = points.begin();  // Wrap around
+    }
+    return it->second;
+}
+
+uint64_t ConsistentHashRing::hash(uint64_t value)
+{
+    // splitmix64
+    value += 0x9E3779B97F4A7C15ULL;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
@@ -0,0 +1,40 @@
+#ifndef CONSISTENTHASHRING_H
+#define CONSISTENTHASHRING_H
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+/**
+ * Consistent-hash ring mapping integer keys to nodes
+ * Every node owns virtualNodes points on a 64-bit ring; a key belongs to
+ * the first point at or after its hash. Adding a node only moves the keys
+ * that land on the new node's points.
+ */
+class ConsistentHashRing
+{
+private:
+    std::vector<std::pair<uint64_t, int>> points;  // (ring position, node), sorted
+    int virtualNodes;
+    int numNodes;
+
+public:
+    // Constructors
+    ConsistentHashRing(int pointsPerNode = 64);
+    
+    // Ring construction
+    void build(int nodes);
+    
+    // Lookup, -1 if the ring is empty
+    int lookup(int key) const;
+    
+    // Getters
+    int getNumNodes() const { return numNodes; }
+    int getVirtualNodes() const { return virtualNodes; }
+    void setVirtualNodes(int pointsPerNode) { virtualNodes = pointsPerNode; }
+
+private:
+    static uint64_t hash(uint64_t value);
+};
+
+#endif // CONSISTENTHASHRING_H
@@ -0,0 +1,128 @@
+#include "ContextTrie.h"
+#include <algorithm>
+
+// Constructors
+ContextTrie::ContextTrie(int order, int nodeBudget, int support)
+{
+    maxOrder = order;
+    maxNodes = nodeBudget;
+    minSupport = support;
+    droppedContexts = 0;
+    nodes.push_back(Node());
+}
+
+void ContextTrie::configure(int order, int nodeBudget, int support)
+{
+    if (order < 1) {
+        throw cRuntimeError("Context trie order must be at least 1, got %d", order);
+    }
+    if (nodeBudget < 2) {
+        throw cRuntimeError("Context trie node budget must be at least 2, got %d", nodeBudget);
+    }
+    if (support < 1) {
+        throw cRuntimeError("Context trie minimum support must be at least 1, got %d", support);
+    }
+    
+    maxOrder = order;
+    maxNodes = nodeBudget;
+    minSupport = support;
+    clear();
+}
+
+// Learning and prediction
+void ContextTrie::record(const std::vector<int>& context, int nextPage)
+{
+    int longest = std::min<int>(maxOrder, context.size());
+    
+    for (int order = 1; order <= longest; order++) {
+        // Walk (creating) the last 'order' pages of the context
+        int node = 0;
+        for (size_t i = context.size() - order; i < context.size() && node >= 0; i++) {
+            node = getOrCreateChild(node, context[i]);
+        }
+        
+        int next = (node >= 0) ? getOrCreateChild(node, nextPage) : -1;
+        if (next < 0) {
+            droppedContexts++;
+            continue;
+        }
+        nodes[next].count++;
+    }
+}
+
+int ContextTrie::predict(const std::vector<int>& context, Predictions& predictions) const
+{
+    predictions.clear();
+    int longest = std::min<int>(maxOrder, context.size());
+    
+    // Longest context with enough support wins; shorter ones are the fallback
+    for (int order = longest; order >= 1; order--) {
+        int node = findContext(context, order);
+        if (node < 0) {
+            continue;
+        }
+        
+        int support = 0;
+        for (int child = nodes[node].firstChild; child >= 0; child = nodes[child].nextSibling) {
+            support += nodes[child].count;
+        }
+        if (support < minSupport) {
+            continue;
+        }
+        
+        for (int child = nodes[node].firstChild; child >= 0; child = nodes[child].nextSibling) {
+            if (nodes[child].count > 0) {
+                predictions.push_back(std::make_pair(nodes[child].page, (double)nodes[child].count / support));
+            }
+        }
+        std::sort(predictions.begin(), predictions.end(),
+                  [](const std::pair<int, double>& a, const std::pair<int, double>& b) { return a.second > b.second; });
+        return order;
+    }
+    
+    return 0;
+}
+
+void ContextTrie::clear()
+{
+    nodes.clear();
+    nodes.push_back(Node());
+    droppedContexts = 0;
+}
+
+// Private helper methods
+int ContextTrie::findChild(int parent, int page) const
+{
+    for (int child = nodes[parent].firstChild; child >= 0; child = nodes[child].nextSibling) {
+        if (nodes[child].page == page) {
+            return child;
+        }
+    }
+    return -1;
+}
+
+int ContextTrie::getOrCreateChild(int parent, int page)
+{
+    int child = findChild(parent, page);
+    if (child >= 0) {
+        return child;
+    }
+    if (isFull()) {
+        return -1;
+    }
+    
+    nodes.push_back(Node(page));
+    int created = nodes.size() - 1;
+    nodes[created].nextSibling = nodes[parent].firstChild;
+    nodes[parent].firstChild = created;
+    return created;
+}
+
+int ContextTrie::findContext(const std::vector<int>& context, int order) const
+{
+    int node = 0;
+    for (size_t i = context.size() - order; i < context.size() && node >= 0; i++) {
+        node = findChild(node, context[i]);
+    }
+    return node;
+}
@@ -0,0 +1,67 @@
+#ifndef CONTEXTTRIE_H
+#define CONTEXTTRIE_H
+
+#include <omnetpp.h>
+#include <vector>
+#include <utility>
+
+using namespace omnetpp;
+
+/**
+ * PPM-style variable-order context trie over page IDs
+ * The path root -> c1 -> ... -> ck is the context (oldest page first);
+ * its children count which page followed that context. Contexts of order
+ * 1..maxOrder are learned for every transition. Prediction uses the
+ * longest context with at least minSupport observations and backs off to
+ * shorter ones. Nodes live in one pool capped at maxNodes; once it is full
+ * only already known contexts keep learning.
+ */
+class ContextTrie
+{
+public:
+    typedef std::vector<std::pair<int, double>> Predictions;  // (page, probability), most likely first
+
+private:
+    // Trie node, children form a singly linked sibling list
+    struct Node {
+        int page;
+        int count;  // Times this page followed the parent context
+        int firstChild;  // -1 if none
+        int nextSibling;  // -1 if none
+        
+        Node(int p = -1) : page(p), count(0), firstChild(-1), nextSibling(-1) {}
+    };
+    
+    std::vector<Node> nodes;  // nodes[0] is the root (empty context)
+    int maxOrder;
+    int maxNodes;
+    int minSupport;
+    long droppedContexts;  // Insertions skipped because the pool was full
+
+public:
+    // Constructors
+    ContextTrie(int order = 3, int nodeBudget = 4096, int support = 3);
+    
+    // Configuration, throws cRuntimeError on invalid values; clears the trie
+    void configure(int order, int nodeBudget, int support);
+    
+    // Learning and prediction; context is ordered oldest to newest
+    void record(const std::vector<int>& context, int nextPage);
+    int predict(const std::vector<int>& context, Predictions& predictions) const;  // Order used, 0 if none
+    void clear();
+    
+    // Getters
+    int getMaxOrder() const { return maxOrder; }
+    int getMaxNodes() const { return maxNodes; }
+    int getMinSupport() const { return minSupport; }
+    int getNodeCount() const { return nodes.size(); }
+    long getDroppedContexts() const { return droppedContexts; }
+    bool isFull() const { return static_cast<int>(nodes.size()) >= maxNodes; }
+
+private:
+    int findChild(int parent, int page) const;
+    int getOrCreateChild(int parent, int page);  // -1 if the pool is full
+    int findContext(const std::vector<int>& context, int order) const;
+};
+
+#endif // CONTEXTTRIE_H
@@ -0,0 +1,159 @@
+#ifndef FLATHASHMAP_H
+#define FLATHASHMAP_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Open-addressing hash map with 64-bit keys for per-request bookkeeping
+ * Linear probing over a power-of-two slot array, backward-shift deletion
+ * (no tombstones), grows at 70% load. Inserts and erases never allocate
+ * once the table has reached its working size.
+ */
+template <typename Value>
+class FlatHashMap
+{
+private:
+    struct Slot {
+        uint64_t key;
+        Value value;
+        bool used;
+        
+        Slot() : key(0), value(), used(false) {}
+    };
+    
+    std::vector<Slot> slots;
+    size_t mask;
+    size_t count;
+
+public:
+    // Constructors
+    FlatHashMap(size_t initialCapacity = 16)
+    {
+        size_t capacity = 16;
+        while (capacity < initialCapacity * 2) {
+            capacity <<= 1;
+        }
+        slots.resize(capacity);
+        mask = capacity - 1;
+        count = 0;
+    }
+    
+    // Lookup methods
+    Value* find(uint64_t key)
+    {
+        size_t index = probe(key);
+        return slots[index].used ? &slots[index].value : nullptr;
+    }
+    
+    const Value* find(uint64_t key) const
+    {
+        size_t index = probe(key);
+        return slots[index].used ? &slots[index].value : nullptr;
+    }
+    
+    bool contains(uint64_t key) const { return slots[probe(key)].used; }
+    
+    // Modification methods
+    Value& operator[](uint64_t key)
+    {
+        size_t index = probe(key);
+        if (!slots[index].used) {
+            if ((count + 1) * 10 > slots.size() * 7) {
+                grow();
+                index = probe(key);
+            }
+            slots[index].key = key;
+            slots[index].value = Value();
+            slots[index].used = true;
+            count++;
+        }
+        return slots[index].value;
+    }
+    
+    // Copy the value out and remove the key; false if absent
+    bool take(uint64_t key, Value& value)
+    {
+        size_t index = probe(key);
+        if (!slots[index].used) {
+            return false;
+        }
+        value = slots[index].value;
+        removeAt(index);
+        return true;
+    }
+    
+    bool erase(uint64_t key)
+    {
+        size_t index = probe(key);
+        if (!slots[index].used) {
+            return false;
+        }
+        removeAt(index);
+        return true;
+    }
+    
+    void clear()
+    {
+        for (auto& slot : slots) {
+            slot = Slot();
+        }
+        count = 0;
+    }
+    
+    // Getters
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+private:
+    static size_t hash(uint64_t key)
+    {
+        // splitmix64 finalizer
+        key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        key = (key ^ (key >> 27)) * 0x94D049BB133111EBULL;
+        return static_cast<size_t>(key ^ (key >> 31));
+    }
+    
+    // Slot holding key, or the empty slot where it would go
+    size_t probe(uint64_t key) const
+    {
+        size_t index = hash(key) & mask;
+        while (slots[index].used && slots[index].key != key) {
+            index = (index + 1) & mask;
+        }
+        return index;
+    }
+    
+    void removeAt(size_t index)
+    {
+        // Backward-shift: pull later entries of the probe run into the hole
+        size_t hole = index;
+        size_t next = (hole + 1) & mask;
+        while (slots[next].used) {
+            size_t home = hash(slots[next].key) & mask;
+            if (((next - home) & mask) >= ((next - hole) & mask)) {
+                slots[hole] = slots[next];
+                hole = next;
+            }
+            next = (next + 1) & mask;
+        }
+        slots[hole] = Slot();
+        count--;
+    }
+    
+    void grow()
+    {
+        std::vector<Slot> old;
+        old.swap(slots);
+        slots.resize(old.size() * 2);
+        mask = slots.size() - 1;
+        for (auto& slot : old) {
+            if (slot.used) {
+                slots[probe(slot.key)] = slot;
+            }
+        }
+    }
+};
+
+#endif // FLATHASHMAP_H
@@ -0,0 +1,125 @@
+#include "HdrHistogram.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+int floorLog2(uint64_t value)
+{
+    int log = 0;
+    while (value >>= 1) {
+        log++;
+    }
+    return log;
+}
+
+}  // namespace
+
+// Constructors
+HdrHistogram::HdrHistogram(double lowestValue, double highestValue, int significantDigits)
+{
+    if (lowestValue <= 0 || highestValue <= lowestValue || significantDigits < 1 || significantDigits > 5) {
+        throw std::invalid_argument("HdrHistogram: need 0 < lowest < highest and 1..5 significant digits");
+    }
+    unit = lowestValue;
+    highestUnits = static_cast<int64_t>(std::ceil(highestValue / lowestValue));
+
+    // Enough linear sub-buckets that one step is below 10^-digits of the value
+    int64_t largestSingleUnitResolution = 2 * static_cast<int64_t>(std::pow(10.0, significantDigits));
+    int subBucketCountMagnitude = static_cast<int>(std::ceil(std::log2(static_cast<double>(largestSingleUnitResolution))));
+    subBucketHalfCountMagnitude = std::max(subBucketCountMagnitude, 1) - 1;
+    subBucketHalfCount = int64_t(1) << subBucketHalfCountMagnitude;
+    int64_t subBucketCount = subBucketHalfCount * 2;
+    subBucketMask = subBucketCount - 1;
+
+    // Power-of-two buckets until the highest value is covered
+    int bucketCount = 1;
+    for (int64_t covered = subBucketCount; covered <= highestUnits; covered <<= 1) {
+        bucketCount++;
+    }
+    counts.assign(static_cast<size_t>(bucketCount + 1) * subBucketHalfCount, 0);
+    clear();
+}
+
+// Recording
+void HdrHistogram::record(double value)
+{
+    if (value < 0) {
+        value = 0;
+    }
+    int64_t units = std::min(static_cast<int64_t>(value / unit), highestUnits);
+    counts[indexOf(units)]++;
+    totalCount++;
+    minValue = std::min(minValue, value);
+    maxValue = std::max(maxValue, value);
+    sum += value;
+}
+
+void HdrHistogram::merge(const HdrHistogram& other)
+{
+    if (other.counts.size() != counts.size() || other.unit != unit) {
+        throw std::invalid_argument("HdrHistogram: merging histograms of different configuration");
+    }
+    for (size_t i = 0; i < counts.size(); i++) {
+        counts[i] += other.counts[i];
+    }
+    if (other.totalCount > 0) {
+        minValue = std::min(minValue, other.minValue);
+        maxValue = std::max(maxValue, other.maxValue);
+    }
+    totalCount += other.totalCount;
+    sum += other.sum;
+}
+
+void HdrHistogram::clear()
+{
+    std::fill(counts.begin(), counts.end(), 0);
+    totalCount = 0;
+    minValue = HUGE_VAL;
+    maxValue = 0;
+    sum = 0;
+}
+
+// Queries
+double HdrHistogram::getValueAtPercentile(double percentile) const
+{
+    if (totalCount == 0) {
+        return 0.0;
+    }
+
+    // Smallest value with at least the requested share of samples at or below it
+    double share = std::min(std::max(percentile, 0.0), 100.0) / 100.0;
+    uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(share * totalCount)));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); i++) {
+        seen += counts[i];
+        if (seen >= target) {
+            double value = (highestEquivalentUnits(i) + 1) * unit;
+            return std::min(std::max(value, minValue), maxValue);
+        }
+    }
+    return maxValue;
+}
+
+// Private helper methods
+size_t HdrHistogram::indexOf(int64_t units) const
+{
+    // Bucket: power of two above the sub-bucket range; sub-bucket: linear position within it
+    int bucketIndex = floorLog2(static_cast<uint64_t>(units | subBucketMask)) - subBucketHalfCountMagnitude;
+    int64_t subBucketIndex = units >> bucketIndex;
+    return static_cast<size_t>(((int64_t)bucketIndex << subBucketHalfCountMagnitude) + subBucketIndex);
+}
+
+int64_t HdrHistogram::highestEquivalentUnits(size_t index) const
+{
+    // Inverse of indexOf: the first half of bucket 0 is one unit per slot
+    int64_t bucketIndex = static_cast<int64_t>(index >> subBucketHalfCountMagnitude) - 1;
+    int64_t subBucketIndex = static_cast<int64_t>(index & (subBucketHalfCount - 1)) + subBucketHalfCount;
+    if (bucketIndex < 0) {
+        subBucketIndex -= subBucketHalfCount;
+        bucketIndex = 0;
+    }
+    int64_t lowest = subBucketIndex << bucketIndex;
+    return lowest + (int64_t(1) << bucketIndex) - 1;
+}
@@ -0,0 +1,53 @@
+#ifndef HDRHISTOGRAM_H
+#define HDRHISTOGRAM_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * High dynamic range histogram of non-negative values (Gil Tene's HdrHistogram)
+ * Values are counted in log-linear buckets: every power-of-two range
+ * holds the same number of linear sub-buckets, so any value between the
+ * lowest and highest trackable value is resolved to a fixed number of
+ * significant decimal digits. Memory is fixed at construction (about
+ * 20 KB for 1us..100s at 2 digits) however many values are recorded;
+ * record() is O(1), percentiles are one pass over the counts.
+ */
+class HdrHistogram
+{
+private:
+    double unit;  // Value of one count unit (the lowest trackable value)
+    int64_t highestUnits;  // Larger values are clamped to this
+    int subBucketHalfCountMagnitude;
+    int64_t subBucketHalfCount;
+    int64_t subBucketMask;
+    std::vector<uint64_t> counts;
+    uint64_t totalCount;
+    double minValue;
+    double maxValue;
+    double sum;
+
+public:
+    // Constructors
+    HdrHistogram(double lowestValue = 1e-6, double highestValue = 100.0, int significantDigits = 2);
+
+    // Recording
+    void record(double value);
+    void merge(const HdrHistogram& other);  // Same configuration required
+    void clear();
+
+    // Queries
+    double getValueAtPercentile(double percentile) const;  // 0..100, 0 if empty
+    uint64_t getCount() const { return totalCount; }
+    double getMin() const { return totalCount ? minValue : 0.0; }
+    double getMax() const { return totalCount ? maxValue : 0.0; }
+    double getMean() const { return totalCount ? sum / totalCount : 0.0; }
+    size_t getMemorySize() const { return sizeof(HdrHistogram) + counts.capacity() * sizeof(uint64_t); }
+
+private:
+    size_t indexOf(int64_t units) const;
+    int64_t highestEquivalentUnits(size_t index) const;
+};
+
+#endif // HDRHISTOGRAM_H
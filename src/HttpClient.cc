@@ -3,14 +3,22 @@
 #include <vector>
 #include <random>
 #include "HttpMessage.h"
+#include "RandomStream.h"
+#include "FlatHashMap.h"
+#include "ResponseCache.h"
+#include "TransmissionQueue.h"
+#include "Visuals.h"
 
 using namespace omnetpp;
 
 /**
  * HTTP Client module implementation
  * Follows 80% predictable pattern (home→login→dashboard cycle) and 20% random selection
+ * An optional private browser cache serves fresh copies locally and revalidates
+ * stale ones with conditional requests (If-None-Match / If-Modified-Since)
+ * Pages pushed by the server are stored there too
  */
-class HttpClient : public cSimpleModule
+class HttpClient : public cSimpleModule, public CacheRemovalListener
 {
 public:
     // Web page definitions (matching server)
@@ -31,24 +39,53 @@ private:
     int responsesReceived;
     int currentPatternStep;  // For tracking position in predictable pattern
     int currentPage;         // Current page the client is on
+    bool visualize;          // Bubbles and display-string updates (configurable)
+    bool verbose;            // Per-request log lines (configurable)
     
     // Pattern control
     std::vector<int> predictablePattern;  // home→login→dashboard cycle
     double patternProbability;            // 80% predictable, 20% random
     
-    // Random number generation
-    std::mt19937 rng;
+    // Random number generation: own streams, independent of other clients' timing
+    RandomStream pageChoiceRng;
+    RandomStream thinkTimeRng;
     std::uniform_real_distribution<double> patternChoice;
     std::uniform_real_distribution<double> thinkTimeDistribution;
     std::uniform_int_distribution<int> randomPageChoice;
     
     // Request tracking for response time measurement
-    std::map<int, simtime_t> pendingRequests;  // requestId → send time
+    FlatHashMap<simtime_t> pendingRequests;  // makeRequestKey(clientId, requestId) → send time
+    
+    // Browser cache: bounded LRU of responses by resourceId; stale entries stay for revalidation
+    static const int CONDITIONAL_HEADER_BYTES = 74;  // If-None-Match and If-Modified-Since lines
+    ResponseCache browserCache;
+    bool browserCacheEnabled;  // browserCacheSize > 0 (configurable)
+    bool revalidate;  // Conditional requests for stale copies, false = full refetch (configurable)
+    int browserCacheHits;
+    int revalidations;  // 304s received
+    int pushReceived;
+    int pushUsed;  // Pushed copies that answered a navigation
+    int pushWasted;  // Pushed copies dropped, replaced or gone stale before any use
+    
+    // Statistics (percentiles come from the responseTime statistic)
+    double responseTimeSum;  // Over network responses
+    int patternFollowed;
+    int randomChoices;
+    
+    // Output link: request bytes set the transmission time
+    TransmissionQueue txQueue;
+    WireFormat requestFormat;  // Header bytes and TCP framing (configurable)
     
     // Statistics signals
     simsignal_t requestSentSignal;
     simsignal_t responseReceivedSignal;
     simsignal_t responseTimeSignal;
+    simsignal_t timeToFirstByteSignal;
+    simsignal_t browserCacheHitSignal;
+    simsignal_t revalidatedSignal;
+    simsignal_t pushReceivedSignal;
+    simsignal_t pushUsedSignal;
+    simsignal_t pushWastedSignal;
     simsignal_t patternFollowedSignal;
     simsignal_t randomChoiceSignal;
     
@@ -65,8 +102,13 @@ protected:
     virtual int selectNextPage();
     virtual int getNextPatternPage();
     virtual int getRandomPage();
+    virtual bool serveFromBrowserCache(int pageId);
     virtual void sendHttpRequest(int pageId);
     virtual void handleHttpResponse(HttpResponse *response);
+    virtual void updateBrowserCache(const HttpResponse *response);
+    virtual void storePush(const HttpResponse *push);
+    virtual void countPushWasted(CacheEntry& entry);
+    virtual void onCacheRemoval(const CacheEntry& entry, CacheRemovalListener::Cause cause) override;
     virtual std::string getPageName(int pageId);
 };
 
@@ -76,9 +118,14 @@ void HttpClient::initialize()
 {
     // Initialize client ID from index or parameter
     clientId = getIndex();
+    visualize = par("visualize").boolValue();
+    verbose = par("verbose").boolValue();
     requestCounter = 0;
     requestsSent = 0;
     responsesReceived = 0;
+    responseTimeSum = 0.0;
+    patternFollowed = 0;
+    randomChoices = 0;
     currentPatternStep = 0;
     currentPage = HOME;  // Start at home page
     
@@ -87,25 +134,59 @@ void HttpClient::initialize()
     patternProbability = 0.8;  // 80% predictable pattern
     
     // Initialize random number generators
-    rng.seed(intuniform(0, 100000) + clientId);  // Unique seed per client
+    pageChoiceRng.seed(getRNG(par("pageChoiceRng").intValue()));  // READ FROM PARAMETERS
+    thinkTimeRng.seed(getRNG(par("thinkTimeRng").intValue()));
     patternChoice = std::uniform_real_distribution<double>(0.0, 1.0);
     thinkTimeDistribution = std::uniform_real_distribution<double>(1.0, 2.0);  // 1-2 seconds
-    randomPageChoice = std::uniform_int_distribution<int>(HOME, LOGOUT);  // All pages
+    int numPages = par("numPages").intValue();  // READ FROM PARAMETERS: size of the server's catalog
+    if (numPages <= 0) {
+        throw cRuntimeError("numPages must be positive");
+    }
+    randomPageChoice = std::uniform_int_distribution<int>(HOME, numPages - 1);  // All pages
     
     // Register statistics signals
     requestSentSignal = registerSignal("requestSent");
     responseReceivedSignal = registerSignal("responseReceived");
     responseTimeSignal = registerSignal("responseTime");
+    timeToFirstByteSignal = registerSignal("timeToFirstByte");
+    browserCacheHitSignal = registerSignal("browserCacheHit");
+    revalidatedSignal = registerSignal("revalidated");
+    pushReceivedSignal = registerSignal("pushReceived");
+    pushUsedSignal = registerSignal("pushUsed");
+    pushWastedSignal = registerSignal("pushWasted");
+    
+    // Initialize browser cache - READ FROM PARAMETERS
+    int browserCacheSize = par("browserCacheSize").intValue();
+    browserCacheEnabled = browserCacheSize > 0;
+    browserCache.setCapacity(browserCacheSize);
+    browserCache.setRemovalListener(this);
+    revalidate = par("revalidate").boolValue();
+    browserCacheHits = 0;
+    revalidations = 0;
+    pushReceived = 0;
+    pushUsed = 0;
+    pushWasted = 0;
     patternFollowedSignal = registerSignal("patternFollowed");
     randomChoiceSignal = registerSignal("randomChoice");
     
+    // Initialize output link - READ FROM PARAMETERS
+    requestFormat.headerBytes = par("requestHeaderBytes").intValue();
+    requestFormat.mss = par("mss").intValue();
+    requestFormat.segmentOverhead = par("segmentOverhead").intValue();
+    if (requestFormat.mss <= 0) {
+        throw cRuntimeError("mss must be positive");
+    }
+    txQueue.init(this, gate("out"), registerSignal("txQueueingDelay"));
+    
     // Set initial client display
-    getDisplayString().setTagArg("i", 1, "blue");
-    getDisplayString().setTagArg("t", 0, ("Client " + std::to_string(clientId) + "\nReady").c_str());
+    IF_VISUALIZE {
+        getDisplayString().setTagArg("i", 1, "blue");
+        getDisplayString().setTagArg("t", 0, ("Client " + std::to_string(clientId) + "\nReady").c_str());
+    }
     
     // Schedule first request after a small random delay
     nextRequestTimer = new cMessage("nextRequest");
-    scheduleAt(simTime() + uniform(0.1, 0.5), nextRequestTimer);
+    scheduleAt(simTime() + thinkTimeRng.uniform(0.1, 0.5), nextRequestTimer);
     
     EV << "HttpClient " << clientId << " initialized, starting at page " << currentPage << endl;
 }
@@ -114,12 +195,16 @@ void HttpClient::handleMessage(cMessage *msg)
 {
     if (msg->isSelfMessage()) {
         if (msg == nextRequestTimer) {
-            // Time to send next request
+            // Time to send next request, unless a fresh local copy answers it
             int nextPage = selectNextPage();
-            sendHttpRequest(nextPage);
+            if (!serveFromBrowserCache(nextPage)) {
+                sendHttpRequest(nextPage);
+            }
             
             // Update current page
             currentPage = nextPage;
+        } else if (TransmissionQueue::isTimer(msg)) {
+            TransmissionQueue::handleTimer(msg);
         }
     } else {
         // Handle HTTP response
@@ -136,12 +221,14 @@ void HttpClient::handleMessage(cMessage *msg)
 int HttpClient::selectNextPage()
 {
     // Decide whether to follow predictable pattern (80%) or choose randomly (20%)
-    if (patternChoice(rng) < patternProbability) {
+    if (patternChoice(pageChoiceRng) < patternProbability) {
         // Follow predictable pattern
+        patternFollowed++;
         emit(patternFollowedSignal, 1);
         return getNextPatternPage();
     } else {
         // Choose random page
+        randomChoices++;
         emit(randomChoiceSignal, 1);
         return getRandomPage();
     }
@@ -154,28 +241,60 @@ int HttpClient::getNextPatternPage()
     currentPatternStep = (currentPatternStep + 1) % predictablePattern.size();
     
     // Visual feedback for pattern following
-    getDisplayString().setTagArg("i", 1, "blue");
-    std::string bubbleText = "Pattern \n" + getPageName(nextPage);
-    bubble(bubbleText.c_str());
+    IF_VISUALIZE {
+        getDisplayString().setTagArg("i", 1, "blue");
+        std::string bubbleText = "Pattern \n" + getPageName(nextPage);
+        bubble(bubbleText.c_str());
+    }
     
-    EV << "Client " << clientId << " following pattern: page " << nextPage << endl;
+    LOG_EV << "Client " << clientId << " following pattern: page " << nextPage << endl;
     return nextPage;
 }
 
 int HttpClient::getRandomPage()
 {
     // Select any page randomly
-    int randomPage = randomPageChoice(rng);
+    int randomPage = randomPageChoice(pageChoiceRng);
     
     // Visual feedback for random selection
-    getDisplayString().setTagArg("i", 1, "orange");
-    std::string bubbleText = "Random \n" + getPageName(randomPage);
-    bubble(bubbleText.c_str());
+    IF_VISUALIZE {
+        getDisplayString().setTagArg("i", 1, "orange");
+        std::string bubbleText = "Random \n" + getPageName(randomPage);
+        bubble(bubbleText.c_str());
+    }
     
-    EV << "Client " << clientId << " random selection: page " << randomPage << endl;
+    LOG_EV << "Client " << clientId << " random selection: page " << randomPage << endl;
     return randomPage;
 }
 
+bool HttpClient::serveFromBrowserCache(int pageId)
+{
+    CacheEntry* entry = browserCacheEnabled ? browserCache.find(pageId) : nullptr;
+    if (!entry || entry->isExpired()) {
+        return false;
+    }
+    
+    // Fresh copy: no request, no network, zero response time
+    if (entry->recordHit() == 1 && entry->isPrefetched()) {
+        pushUsed++;
+        emit(pushUsedSignal, 1);
+    }
+    browserCache.touch(pageId);
+    browserCacheHits++;
+    emit(browserCacheHitSignal, 1);
+    emit(responseTimeSignal, 0.0);
+    
+    IF_VISUALIZE {
+        getDisplayString().setTagArg("i", 1, "green");
+        std::string bubbleText = "Local \n" + getPageName(pageId);
+        bubble(bubbleText.c_str());
+    }
+    LOG_EV << "Client " << clientId << " served page " << pageId << " from its browser cache" << endl;
+    
+    scheduleNextRequest();
+    return true;
+}
+
 void HttpClient::sendHttpRequest(int pageId)
 {
     requestCounter++;
@@ -189,49 +308,90 @@ void HttpClient::sendHttpRequest(int pageId)
     request->setFromPage(currentPage);  // Track navigation pattern
     request->setTimestamp(simTime());
     
+    // Stale browser copy: ask the server whether it is still current
+    CacheEntry* stale = browserCacheEnabled && revalidate ? browserCache.find(pageId) : nullptr;
+    int validatorBytes = 0;
+    if (browserCacheEnabled) {
+        CacheEntry* expired = browserCache.find(pageId);
+        if (expired) {
+            countPushWasted(*expired);  // Went stale unused
+        }
+    }
+    if (stale) {
+        request->setConditional(stale->getEtag(), stale->getLastModified());
+        validatorBytes = CONDITIONAL_HEADER_BYTES;
+    }
+    request->setByteLength(requestFormat.messageBytes(request->getUrl().length() + validatorBytes));
+    
     // Store send time for response time calculation
-    pendingRequests[requestCounter] = simTime();
+    pendingRequests[makeRequestKey(clientId, requestCounter)] = simTime();
     
     // Send request to server
-    send(request, "out");
+    txQueue.send(request);
     
     // Visual feedback for sending request
-    getDisplayString().setTagArg("i", 1, "yellow");
-    std::string bubbleText = "Request \n" + getPageName(pageId);
-    bubble(bubbleText.c_str());
+    IF_VISUALIZE {
+        getDisplayString().setTagArg("i", 1, "yellow");
+        std::string bubbleText = "Request \n" + getPageName(pageId);
+        bubble(bubbleText.c_str());
+    }
     
     emit(requestSentSignal, requestsSent);
     
-    EV << "Client " << clientId << " sent request " << requestCounter 
+    LOG_EV << "Client " << clientId << " sent request " << requestCounter 
        << " for page " << pageId << " (from page " << currentPage << ")" << endl;
 }
 
 void HttpClient::handleHttpResponse(HttpResponse *response)
 {
-    responsesReceived++;
-    
     int requestId = response->getRequestId();
     int pageId = response->getResourceId();
     
+    // The first chunk (or the whole response) marks the first byte
+    if (response->getChunkIndex() == 0) {
+        simtime_t *sendTime = pendingRequests.find(makeRequestKey(clientId, requestId));
+        if (sendTime) {
+            emit(timeToFirstByteSignal, (simTime() - *sendTime).dbl());
+        }
+    }
+    
+    // A chunked response is complete with its last chunk
+    if (!response->isLastChunk()) {
+        return;
+    }
+    
+    // Pushed page: answers no request, only fills the browser cache
+    if (response->isPushed()) {
+        storePush(response);
+        return;
+    }
+    
+    responsesReceived++;
+    if (browserCacheEnabled) {
+        updateBrowserCache(response);
+    }
+    
     // Calculate and record response time
-    auto it = pendingRequests.find(requestId);
-    if (it != pendingRequests.end()) {
-        simtime_t responseTime = simTime() - it->second;
+    simtime_t sendTime;
+    if (pendingRequests.take(makeRequestKey(clientId, requestId), sendTime)) {
+        simtime_t responseTime = simTime() - sendTime;
+        responseTimeSum += responseTime.dbl();
         emit(responseTimeSignal, responseTime.dbl());
-        pendingRequests.erase(it);
         
         // Visual feedback for response received
-        if (responseTime < 0.05) { // Fast response (likely cache hit)
-            getDisplayString().setTagArg("i", 1, "green");
-            std::string bubbleText = "Fast \n" + getPageName(pageId) + " " + std::to_string((int)(responseTime.dbl()*1000)) + "ms";
-            bubble(bubbleText.c_str());
-        } else { // Normal response
-            getDisplayString().setTagArg("i", 1, "blue");
-            std::string bubbleText = "Response \n" + getPageName(pageId) + " " + std::to_string((int)(responseTime.dbl()*1000)) + "ms";
-            bubble(bubbleText.c_str());
+        IF_VISUALIZE {
+            if (responseTime < 0.05) { // Fast response (likely cache hit)
+                getDisplayString().setTagArg("i", 1, "green");
+                std::string bubbleText = "Fast \n" + getPageName(pageId) + " " + std::to_string((int)(responseTime.dbl()*1000)) + "ms";
+                bubble(bubbleText.c_str());
+            } else { // Normal response
+                getDisplayString().setTagArg("i", 1, "blue");
+                std::string bubbleText = "Response \n" + getPageName(pageId) + " " + std::to_string((int)(responseTime.dbl()*1000)) + "ms";
+                bubble(bubbleText.c_str());
+            }
         }
         
-        EV << "Client " << clientId << " received response for request " << requestId 
+        LOG_EV << "Client " << clientId << " received response for request " << requestId 
            << " (page " << pageId << ") - Response time: " << responseTime << "s" << endl;
     } else {
         EV << "WARNING: Received response for unknown request " << requestId << endl;
@@ -243,25 +403,90 @@ void HttpClient::handleHttpResponse(HttpResponse *response)
     scheduleNextRequest();
 }
 
+void HttpClient::updateBrowserCache(const HttpResponse *response)
+{
+    int pageId = response->getResourceId();
+    
+    // 304: the stale copy is current again for another max-age
+    if (response->isNotModified()) {
+        CacheEntry* entry = browserCache.find(pageId);
+        if (entry) {
+            entry->refresh(entry->getContentHandle(), response->getTtl());
+            browserCache.touch(pageId);
+        }
+        revalidations++;
+        emit(revalidatedSignal, 1);
+        return;
+    }
+    
+    if (response->getStatusCode() != 200 || !response->isCacheable() || response->getTtl() <= 0) {
+        return;
+    }
+    
+    // Full response: keep it, the least recently used copy makes room
+    if (!browserCache.contains(pageId) && browserCache.isFull()) {
+        browserCache.evict(pageId);
+    }
+    CacheEntry entry(pageId, response->getContentHandle(), response->getTtl());
+    entry.setValidators(response->getEtag(), response->getLastModified());
+    browserCache.insert(entry);
+}
+
+void HttpClient::storePush(const HttpResponse *push)
+{
+    int pageId = push->getResourceId();
+    pushReceived++;
+    emit(pushReceivedSignal, 1);
+    
+    // Without a browser cache, or with a fresh copy already held, the push is of no use
+    CacheEntry* held = browserCacheEnabled ? browserCache.find(pageId) : nullptr;
+    if (!browserCacheEnabled || (held && !held->isExpired()) || push->getTtl() <= 0) {
+        pushWasted++;
+        emit(pushWastedSignal, 1);
+        return;
+    }
+    
+    if (!held && browserCache.isFull()) {
+        browserCache.evict(pageId);
+    }
+    CacheEntry entry(pageId, push->getContentHandle(), push->getTtl());
+    entry.setValidators(push->getEtag(), push->getLastModified());
+    entry.setProvenance(CacheEntry::PREFETCHED);
+    browserCache.insert(entry);
+    
+    LOG_EV << "Client " << clientId << " stored pushed page " << pageId << endl;
+}
+
+void HttpClient::countPushWasted(CacheEntry& entry)
+{
+    if (entry.isPrefetched() && entry.getHits() == 0) {
+        pushWasted++;
+        emit(pushWastedSignal, 1);
+        entry.setProvenance(CacheEntry::DEMAND_FILLED);  // Counted once
+    }
+}
+
+void HttpClient::onCacheRemoval(const CacheEntry& entry, CacheRemovalListener::Cause /*cause*/)
+{
+    // Evicted or overwritten before use (stale copies were already counted in sendHttpRequest)
+    if (entry.isPrefetched() && entry.getHits() == 0) {
+        pushWasted++;
+        emit(pushWastedSignal, 1);
+    }
+}
+
 void HttpClient::scheduleNextRequest()
 {
-    double thinkTime = thinkTimeDistribution(rng);
+    double thinkTime = thinkTimeDistribution(thinkTimeRng);
     scheduleAt(simTime() + thinkTime, nextRequestTimer);
     
-    EV << "Client " << clientId << " will send next request in " << thinkTime << "s" << endl;
+    LOG_EV << "Client " << clientId << " will send next request in " << thinkTime << "s" << endl;
 }
 
 void HttpClient::finish()
 {
-    // Calculate statistics
-    double avgResponseTime = 0.0;
-    if (responsesReceived > 0) {
-        // This would be calculated from collected response times in a real implementation
-        avgResponseTime = 0.15;  // Placeholder
-    }
-    
-    int patternFollowed = 0;  // Would track from signals in real implementation
-    int randomChoices = 0;    // Would track from signals in real implementation
+    // Calculate statistics (browser cache hits are not network responses)
+    double avgResponseTime = responsesReceived > 0 ? responseTimeSum / responsesReceived : 0.0;
     
     EV << "HttpClient " << clientId << " statistics:" << endl;
     EV << "  Total requests sent: " << requestsSent << endl;
@@ -278,13 +503,24 @@ void HttpClient::finish()
     recordScalar("avgResponseTime", avgResponseTime);
     recordScalar("patternFollowed", patternFollowed);
     recordScalar("randomChoices", randomChoices);
+    if (browserCacheEnabled) {
+        recordScalar("browserCacheHits", browserCacheHits);
+        recordScalar("revalidations", revalidations);
+        recordScalar("pushReceived", pushReceived);
+        recordScalar("pushUsed", pushUsed);
+        recordScalar("pushWasted", pushWasted);
+        recordScalar("browserCacheHitRate", requestsSent + browserCacheHits > 0 ? 
+                     (double)browserCacheHits / (requestsSent + browserCacheHits) : 0.0);
+    }
     
     // Clean up
     cancelAndDelete(nextRequestTimer);
+    txQueue.clear();
 }
 
 std::string HttpClient::getPageName(int pageId)
 {
+    // The client does not load the server's catalog: pages past the built-in six go by id
     switch(pageId) {
         case HOME: return "home";
         case LOGIN: return "login";
@@ -292,6 +528,6 @@ std::string HttpClient::getPageName(int pageId)
         case PROFILE: return "profile";
         case SETTINGS: return "settings";
         case LOGOUT: return "logout";
-        default: return "unknown";
+        default: return "page " + std::to_string(pageId);
     }
 }
\ No newline at end of file
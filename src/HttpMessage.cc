@@ -1,8 +1,29 @@
 #include "HttpMessage.h"
 #include <sstream>
+#include <algorithm>
+
+// WireFormat implementation
+int64_t WireFormat::framed(int64_t payloadBytes) const
+{
+    if (segmentOverhead <= 0) {
+        return payloadBytes;
+    }
+    int64_t segments = std::max<int64_t>(1, (payloadBytes + mss - 1) / mss);
+    return payloadBytes + segments * segmentOverhead;
+}
+
+int64_t WireFormat::chunkFraming(int64_t chunkBytes, bool last)
+{
+    // Hex size line and CRLF after the data; the last chunk is followed by "0\r\n\r\n"
+    int hexDigits = 1;
+    for (int64_t rest = chunkBytes >> 4; rest > 0; rest >>= 4) {
+        hexDigits++;
+    }
+    return hexDigits + 4 + (last ? 5 : 0);
+}
 
 // HttpRequest implementation
-HttpRequest::HttpRequest(const char* name) : cMessage(name)
+HttpRequest::HttpRequest(const char* name) : cPacket(name)
 {
     requestId = 0;
     clientId = 0;
@@ -10,9 +31,13 @@ HttpRequest::HttpRequest(const char* name) : cMessage(name)
     url = "";
     timestamp = SIMTIME_ZERO;
     fromPage = -1;
+    conditional = false;
+    ifNoneMatch = 0;
+    ifModifiedSince = SIMTIME_ZERO;
+    responseSize = 0;
 }
 
-HttpRequest::HttpRequest(const HttpRequest& other) : cMessage(other)
+HttpRequest::HttpRequest(const HttpRequest& other) : cPacket(other)
 {
     requestId = other.requestId;
     clientId = other.clientId;
@@ -20,6 +45,10 @@ HttpRequest::HttpRequest(const HttpRequest& other) : cMessage(other)
     url = other.url;
     timestamp = other.timestamp;
     fromPage = other.fromPage;
+    conditional = other.conditional;
+    ifNoneMatch = other.ifNoneMatch;
+    ifModifiedSince = other.ifModifiedSince;
+    responseSize = other.responseSize;
 }
 
 HttpRequest::~HttpRequest()
@@ -31,13 +60,17 @@ HttpRequest& HttpRequest::operator=(const HttpRequest& other)
 {
     if (this == &other) return *this;
     
-    cMessage::operator=(other);
+    cPacket::operator=(other);
     requestId = other.requestId;
     clientId = other.clientId;
     resourceId = other.resourceId;
     url = other.url;
     timestamp = other.timestamp;
     fromPage = other.fromPage;
+    conditional = other.conditional;
+    ifNoneMatch = other.ifNoneMatch;
+    ifModifiedSince = other.ifModifiedSince;
+    responseSize = other.responseSize;
     
     return *this;
 }
@@ -60,26 +93,40 @@ std::string HttpRequest::toString() const
 }
 
 // HttpResponse implementation
-HttpResponse::HttpResponse(const char* name) : cMessage(name)
+HttpResponse::HttpResponse(const char* name) : cPacket(name)
 {
     requestId = 0;
+    clientId = 0;
     resourceId = 0;
-    content = "";
+    content = nullptr;
     contentSize = 0;
     timestamp = SIMTIME_ZERO;
     ttl = 3600; // Default 1 hour
     cacheable = true;
+    statusCode = 200;
+    pushed = false;
+    etag = 0;
+    lastModified = SIMTIME_ZERO;
+    chunkIndex = 0;
+    numChunks = 1;
 }
 
-HttpResponse::HttpResponse(const HttpResponse& other) : cMessage(other)
+HttpResponse::HttpResponse(const HttpResponse& other) : cPacket(other)
 {
     requestId = other.requestId;
+    clientId = other.clientId;
     resourceId = other.resourceId;
     content = other.content;
     contentSize = other.contentSize;
     timestamp = other.timestamp;
     ttl = other.ttl;
     cacheable = other.cacheable;
+    statusCode = other.statusCode;
+    pushed = other.pushed;
+    etag = other.etag;
+    lastModified = other.lastModified;
+    chunkIndex = other.chunkIndex;
+    numChunks = other.numChunks;
 }
 
 HttpResponse::~HttpResponse()
@@ -91,14 +138,21 @@ HttpResponse& HttpResponse::operator=(const HttpResponse& other)
 {
     if (this == &other) return *this;
     
-    cMessage::operator=(other);
+    cPacket::operator=(other);
     requestId = other.requestId;
+    clientId = other.clientId;
     resourceId = other.resourceId;
     content = other.content;
     contentSize = other.contentSize;
     timestamp = other.timestamp;
     ttl = other.ttl;
     cacheable = other.cacheable;
+    statusCode = other.statusCode;
+    pushed = other.pushed;
+    etag = other.etag;
+    lastModified = other.lastModified;
+    chunkIndex = other.chunkIndex;
+    numChunks = other.numChunks;
     
     return *this;
 }
@@ -112,6 +166,7 @@ std::string HttpResponse::toString() const
 {
     std::ostringstream oss;
     oss << "HttpResponse{requestId=" << requestId
+        << ", clientId=" << clientId
         << ", resourceId=" << resourceId
         << ", contentSize=" << contentSize
         << ", timestamp=" << timestamp
@@ -128,4 +183,69 @@ bool HttpResponse::isExpired() const
     simtime_t expiryTime = timestamp + ttl;
     
     return currentTime >= expiryTime;
+}
+
+// PendingResponse implementation
+PendingResponse::PendingResponse(const char* name, short kind) : cMessage(name, kind)
+{
+    requestId = 0;
+    clientId = 0;
+    resourceId = 0;
+    fromPage = -1;
+    arrivalGate = -1;
+    content = nullptr;
+    serviceTime = 0.0;
+    notModified = false;
+    responseSize = 0;
+}
+
+PendingResponse::PendingResponse(const PendingResponse& other) : cMessage(other)
+{
+    requestId = other.requestId;
+    clientId = other.clientId;
+    resourceId = other.resourceId;
+    fromPage = other.fromPage;
+    arrivalGate = other.arrivalGate;
+    content = other.content;
+    serviceTime = other.serviceTime;
+    notModified = other.notModified;
+    responseSize = other.responseSize;
+}
+
+PendingResponse::~PendingResponse()
+{
+    // No dynamic memory to clean up
+}
+
+PendingResponse& PendingResponse::operator=(const PendingResponse& other)
+{
+    if (this == &other) return *this;
+    
+    cMessage::operator=(other);
+    requestId = other.requestId;
+    clientId = other.clientId;
+    resourceId = other.resourceId;
+    fromPage = other.fromPage;
+    arrivalGate = other.arrivalGate;
+    content = other.content;
+    serviceTime = other.serviceTime;
+    notModified = other.notModified;
+    responseSize = other.responseSize;
+    
+    return *this;
+}
+
+PendingResponse* PendingResponse::dup() const
+{
+    return new PendingResponse(*this);
+}
+
+void PendingResponse::setRequest(const HttpRequest* request)
+{
+    requestId = request->getRequestId();
+    clientId = request->getClientId();
+    resourceId = request->getResourceId();
+    fromPage = request->getFromPage();
+    responseSize = request->getResponseSize();
+    arrivalGate = request->getArrivalGate()->getIndex();
 }
\ No newline at end of file
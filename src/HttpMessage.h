@@ -3,14 +3,46 @@
 
 #include <omnetpp.h>
 #include <string>
+#include <cstdint>
+#include "PageContent.h"
 
 using namespace omnetpp;
 
+/**
+ * Globally unique request key
+ * Every client numbers its requests from 1, so requestId alone collides
+ * across clients; (clientId, requestId) packed into 64 bits does not.
+ */
+inline uint64_t makeRequestKey(int clientId, int requestId)
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(clientId)) << 32) | static_cast<uint32_t>(requestId);
+}
+
+/**
+ * Wire size model for HTTP messages
+ * A message is its header bytes plus its body. With segmentOverhead > 0 the
+ * bytes travel in TCP segments of at most mss bytes, each carrying that
+ * many extra bytes of TCP/IP (and link) headers.
+ */
+struct WireFormat
+{
+    int headerBytes;
+    int mss;
+    int segmentOverhead;
+    
+    WireFormat() : headerBytes(0), mss(1460), segmentOverhead(0) {}
+    
+    int64_t framed(int64_t payloadBytes) const;  // Adds the segment overhead
+    int64_t messageBytes(int64_t bodyBytes) const { return framed(headerBytes + bodyBytes); }
+    static int64_t chunkFraming(int64_t chunkBytes, bool last);  // Chunked transfer coding around one chunk
+};
+
 /**
  * HTTP Request message class
  * Represents an HTTP request with necessary fields for predictive caching
+ * It is a packet: its byte length sets its transmission time on the link
  */
-class HttpRequest : public cMessage
+class HttpRequest : public cPacket
 {
 private:
     int requestId;
@@ -19,7 +51,11 @@ private:
     std::string url;
     simtime_t timestamp;
     int fromPage;  // For pattern tracking
-    
+    bool conditional;  // Revalidation of a stale client copy
+    uint32_t ifNoneMatch;  // ETag of that copy, 0 = none
+    simtime_t ifModifiedSince;  // Last-Modified of that copy
+    int responseSize;  // Body size logged for a replayed request, 0 = the page's own size
+
 public:
     // Constructors
     HttpRequest(const char* name = "HttpRequest");
@@ -39,6 +75,11 @@ public:
     const std::string& getUrl() const { return url; }
     simtime_t getTimestamp() const { return timestamp; }
     int getFromPage() const { return fromPage; }
+    uint64_t getRequestKey() const { return makeRequestKey(clientId, requestId); }
+    bool isConditional() const { return conditional; }
+    uint32_t getIfNoneMatch() const { return ifNoneMatch; }
+    simtime_t getIfModifiedSince() const { return ifModifiedSince; }
+    int getResponseSize() const { return responseSize; }
     
     // Setters
     void setRequestId(int id) { requestId = id; }
@@ -47,6 +88,8 @@ public:
     void setUrl(const std::string& u) { url = u; }
     void setTimestamp(simtime_t t) { timestamp = t; }
     void setFromPage(int page) { fromPage = page; }
+    void setConditional(uint32_t etag, simtime_t lastModified) { conditional = true; ifNoneMatch = etag; ifModifiedSince = lastModified; }
+    void setResponseSize(int size) { responseSize = size; }
     
     // Utility methods
     std::string toString() const;
@@ -55,18 +98,28 @@ public:
 /**
  * HTTP Response message class  
  * Represents an HTTP response with cache-relevant information
+ * The body is a shared immutable handle, so dup() only bumps a refcount
+ * A chunked response travels as numChunks packets that all carry the full
+ * fields; the byte length of each is that chunk's share of the wire bytes.
  */
-class HttpResponse : public cMessage
+class HttpResponse : public cPacket
 {
 private:
     int requestId;
+    int clientId;  // Requesting client, lets a load balancer route the response back
     int resourceId;
-    std::string content;
+    PageContent content;
     int contentSize;
     simtime_t timestamp;
     int ttl;  // Time to live in seconds
     bool cacheable;
-    
+    int statusCode;  // 200, 304 (not modified, no body), 404 or 503
+    bool pushed;  // Server push of a predicted page, answers no request
+    uint32_t etag;  // Validator of the body, 0 = none
+    simtime_t lastModified;
+    int chunkIndex;
+    int numChunks;
+
 public:
     // Constructors
     HttpResponse(const char* name = "HttpResponse");
@@ -81,25 +134,102 @@ public:
     
     // Getters
     int getRequestId() const { return requestId; }
+    int getClientId() const { return clientId; }
     int getResourceId() const { return resourceId; }
-    const std::string& getContent() const { return content; }
+    const std::string& getContent() const { return getPageContentText(content); }
+    const PageContent& getContentHandle() const { return content; }
     int getContentSize() const { return contentSize; }
     simtime_t getTimestamp() const { return timestamp; }
     int getTtl() const { return ttl; }
     bool isCacheable() const { return cacheable; }
+    int getStatusCode() const { return statusCode; }
+    bool isNotModified() const { return statusCode == 304; }
+    bool isPushed() const { return pushed; }
+    uint32_t getEtag() const { return etag; }
+    simtime_t getLastModified() const { return lastModified; }
+    int getChunkIndex() const { return chunkIndex; }
+    int getNumChunks() const { return numChunks; }
+    bool isLastChunk() const { return chunkIndex == numChunks - 1; }
     
     // Setters
     void setRequestId(int id) { requestId = id; }
+    void setClientId(int id) { clientId = id; }
     void setResourceId(int id) { resourceId = id; }
-    void setContent(const std::string& c) { content = c; contentSize = c.length(); }
+    void setContent(const PageContent& c) { content = c; contentSize = getPageContentSize(c); }
+    void setContent(const std::string& c) { setContent(makePageContent(c)); }
     void setContentSize(int size) { contentSize = size; }
     void setTimestamp(simtime_t t) { timestamp = t; }
     void setTtl(int t) { ttl = t; }
     void setCacheable(bool c) { cacheable = c; }
+    void setStatusCode(int code) { statusCode = code; }
+    void setPushed(bool p) { pushed = p; }
+    void setValidators(uint32_t tag, simtime_t modified) { etag = tag; lastModified = modified; }
+    void setChunk(int index, int count) { chunkIndex = index; numChunks = count; }
     
     // Utility methods
     std::string toString() const;
     bool isExpired() const;
 };
 
+/**
+ * Message kinds of the server's self-messages
+ * The server dispatches on getKind() instead of comparing message names
+ */
+enum ServerMessageKind {
+    SERVER_CACHED_RESPONSE = 1,  // PendingResponse: cache hit ready to be sent
+    SERVER_DELAYED_PROCESSING,   // PendingResponse: cache miss finished processing
+    SERVER_CACHE_EXPIRY,         // Earliest cache entry is due to expire
+    SERVER_CONTROLLER_TICK,      // Adaptive threshold control interval elapsed
+    SERVER_PREFETCH_COMPLETE     // PendingResponse: background prefetch finished generating
+};
+
+/**
+ * Server-internal self-message for a response in preparation
+ * Carries the request state as typed fields instead of dynamically added cPar objects
+ */
+class PendingResponse : public cMessage
+{
+private:
+    int requestId;
+    int clientId;
+    int resourceId;
+    int fromPage;
+    int arrivalGate;  // Index of the server gate the request came in on
+    PageContent content;  // Cached body for cache hits, empty otherwise
+    double serviceTime;  // Worker time the job needs (s)
+    bool notModified;  // Answer a matching conditional request with a 304
+    int responseSize;  // The request's logged body size, 0 = the page's own size
+
+public:
+    // Constructors
+    PendingResponse(const char* name = "PendingResponse", short kind = SERVER_DELAYED_PROCESSING);
+    PendingResponse(const PendingResponse& other);
+    virtual ~PendingResponse();
+    
+    // Assignment operator
+    PendingResponse& operator=(const PendingResponse& other);
+    
+    // Clone method for OMNeT++ message handling
+    virtual PendingResponse* dup() const override;
+    
+    // Getters
+    int getRequestId() const { return requestId; }
+    int getClientId() const { return clientId; }
+    int getResourceId() const { return resourceId; }
+    int getFromPage() const { return fromPage; }
+    int getArrivalGateIndex() const { return arrivalGate; }
+    uint64_t getRequestKey() const { return makeRequestKey(clientId, requestId); }
+    const PageContent& getContent() const { return content; }
+    double getServiceTime() const { return serviceTime; }
+    bool isNotModified() const { return notModified; }
+    int getResponseSize() const { return responseSize; }
+    
+    // Setters
+    void setRequest(const HttpRequest* request);  // Copies ids, the response size and the arrival gate
+    void setResourceId(int id) { resourceId = id; }  // Jobs without a request (prefetch)
+    void setContent(const PageContent& c) { content = c; }
+    void setServiceTime(double t) { serviceTime = t; }
+    void setNotModified(bool n) { notModified = n; }
+};
+
 #endif // HTTPMESSAGE_H
\ No newline at end of file
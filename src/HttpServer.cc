@@ -1,20 +1,39 @@
 #include <omnetpp.h>
+#include <omnetpp/cconfigurationex.h>
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <random>
 #include <algorithm>
 #include <iomanip>
+#include <cstdlib>
 #include "HttpMessage.h"
 #include "CacheEntry.h"
+#include "PageCatalog.h"
+#include "PatternTable.h"
+#include "SharedPatternTable.h"
+#include "ConsistentHashRing.h"
+#include "SessionPredictor.h"
+#include "ResponseCache.h"
+#include "ThresholdController.h"
+#include "CacheCodec.h"
+#include "TokenBucket.h"
+#include "WorkerPool.h"
+#include "TransmissionQueue.h"
+#include "FlatHashMap.h"
+#include "HdrHistogram.h"
+#include "RandomStream.h"
+#include "Visuals.h"
 
 using namespace omnetpp;
 
 /**
  * HTTP Server module implementation
- * Handles HTTP requests for 6 web pages with random processing delay
+ * Handles HTTP requests for the pages of its catalog (6 built-in pages by default)
+ * with random processing delay
  */
-class HttpServer : public cSimpleModule
+class HttpServer : public cSimpleModule, public CacheRemovalListener
 {
 public:
     // Web page definitions
@@ -26,54 +45,127 @@ public:
         SETTINGS = 4,
         LOGOUT = 5
     };
+    
+    // Source of next-page predictions
+    enum PredictorMode {
+        PREDICT_GLOBAL = 0,   // Global transition table only
+        PREDICT_SESSION = 1,  // Client's own history, global table as fallback
+        PREDICT_PPM = 2       // Variable-order contexts of the client's last pages
+    };
 
 private:
-    // Web page information structure
-    struct PageInfo {
-        int pageId;
-        std::string pageName;
-        std::string content;
-        int contentSize;
-        int ttl;  // Time to live in seconds
-        
-        // Default constructor for map operations
-        PageInfo() : pageId(-1), pageName(""), content(""), contentSize(0), ttl(3600) {}
-        
-        PageInfo(int id, const std::string& name, const std::string& pageContent, int ttlSeconds = 3600)
-            : pageId(id), pageName(name), content(pageContent), ttl(ttlSeconds) {
-            contentSize = pageContent.length();
-        }
-    };
-    
     // Server state variables
-    std::map<int, PageInfo> webPages;  // pageId -> PageInfo
+    PageCatalog webPages;  // resourceId -> PageInfo, built-in pages or loaded from catalogFile
     int requestsReceived;
     int responsesGenerated;
+    bool visualize;  // Bubbles and display-string updates (configurable)
+    bool verbose;  // Per-request log lines (configurable)
     
     // Pattern learning variables
-    std::map<std::pair<std::string, std::string>, int> patternTable;  // (fromPage, toPage) -> count
-    std::map<int, std::string> clientLastPage;  // clientId -> last page visited
+    PatternTable ownPatternTable;  // (fromPage, toPage) -> count, indexed by resourceId
+    PatternTable* patternTable;  // ownPatternTable, or the table of a SharedPatternTable module
+    SessionPredictor sessionPredictor;  // clientId -> recent page history (ring buffer)
+    PredictorMode predictorMode;  // Configurable via 'predictor' parameter
+    PatternTable::Predictions predictionBuffer;  // Reused by predictivePreCache, no allocation per request
+    std::string patternSnapshotFile;  // Warm-start snapshot, empty = start cold (configurable)
+    bool ownsPatternSnapshot;  // Only one shard loads and saves a shared table
+    bool savePatternSnapshot;
+    
+    // Scale-out: the load balancer's ring, so a shard only prefetches pages routed to it
+    int shardIndex;  // This server's node on the ring, -1 = every page is ours (configurable)
+    ConsistentHashRing shardRing;
     
     // Predictive caching variables
-    std::map<std::string, CacheEntry> responseCache;  // pageName -> cached response
+    ResponseCache responseCache;  // resourceId -> cached response (LRU list + TTL heap)
     double predictionThreshold;  // Minimum probability for pre-caching (configurable)
     int cacheTTL;  // Cache entry time-to-live in seconds (configurable)
     
+    // Adaptive threshold: prefetch precision feedback adjusts predictionThreshold (and cacheTTL)
+    ThresholdController thresholdController;  // Also counts prefetch outcomes when not adaptive
+    bool adaptiveThreshold;
+    simtime_t controllerInterval;
+    cMessage* controllerTimer;
+    long intervalRequests;  // Demand requests since the last control step
+    
+    // Prefetch accounting: outcome of every pre-cached entry, and the work it cost
+    TokenBucket prefetchBudget;  // Seconds of generation work per simulated second (configurable)
+    long prefetchIssued;
+    long prefetchUseful;  // Hit at least once
+    long prefetchExpiredUnused;  // Expired before any hit
+    long prefetchEvictedUnused;  // Evicted or replaced before any hit
+    long prefetchBudgetDenied;
+    double prefetchWork;  // Summed generation cost of issued prefetches (s)
+    long prefetchLate;  // Demand requests that joined a prefetch still being generated
+    long prefetchDropped;  // Prefetch jobs refused by a full worker queue
+    
+    // Server push: cached predicted pages are sent to the client ahead of its request
+    int pushCount;  // Pages pushed per response, 0 = no push (configurable)
+    double pushThreshold;  // Minimum prediction probability (configurable)
+    double pushBudgetRate;  // Bytes per second per client, 0 = unlimited (configurable)
+    double pushBudgetBurst;  // Bytes (configurable)
+    std::unordered_map<int, TokenBucket> pushBudgets;  // clientId -> byte budget
+    FlatHashMap<simtime_t> pushedUntil;  // makeRequestKey(clientId, page) -> expiry of the pushed copy
+    long pushSent;
+    int64_t pushBytes;
+    long pushBudgetDenied;
+    long pushDuplicates;  // Requests for a page whose push should still be fresh at the client
+    
+    // Page generation (prefetch or miss) running on a worker; demand requests for the page wait for it
+    struct InFlightGeneration {
+        bool prefetch;  // Background prefetch, or a demand miss (single-flight leader)
+        double probability;  // Prediction that triggered the prefetch (admission weight)
+        double cost;  // Generation time (s)
+        PendingResponse* job;  // Running or queued generation job
+        std::vector<PendingResponse*> waiters;  // Owned until the generation completes
+        
+        InFlightGeneration() : prefetch(false), probability(0.0), cost(0.0), job(nullptr) {}
+    };
+    std::unordered_map<int, InFlightGeneration> inFlight;  // resourceId -> generation
+    bool coalesceMisses;  // Single-flight: concurrent misses share one generation (configurable)
+    bool demandFill;  // Cache generated miss responses too (configurable)
+    
+    // Client caching: max-age advertised on responses, 304s for matching revalidations
+    int responseMaxAge;  // Seconds, -1 = the page's own TTL (configurable)
+    long notModifiedSent;
+    long missesCoalesced;
+    
     // Cache management variables
-    std::map<std::string, cMessage*> cacheExpiryMessages;  // pageName -> expiry message
     int maxCacheSize;  // Maximum number of cached entries (configurable)
-    int currentCacheSize;  // Current number of cached entries
-    double cacheCleanupInterval;  // Periodic cleanup interval in seconds
-    cMessage* cacheCleanupTimer;  // Timer for periodic cleanup
+    long maxCacheBytes;  // Byte budget over CacheEntry::getMemorySize(), 0 = none (configurable)
+    cMessage* cacheExpiryTimer;  // Single timer for the earliest pending cache expiry
+    
+    // Compressed storage tier: cold entries are stored compressed, hits pay the decompression
+    CacheCodec cacheCodec;  // Modelled codec (configurable)
+    long compressMinSize;  // Smaller bodies are never compressed (configurable)
+    int compressHotHits;  // Hits after which an entry is stored uncompressed again, 0 = never (configurable)
+    long compressedInserts;
+    long decompressions;
+    long compressionPromotions;
+    double totalDecompressionTime;
+    
+    // Output links: responses wait for a busy link, their size sets the transmission time
+    std::vector<TransmissionQueue> txQueues;  // One per out[] gate
+    WireFormat responseFormat;  // Header bytes and TCP framing (configurable)
+    int chunkSize;  // Chunked transfer coding, 0 = whole responses (configurable)
+    
+    // Concurrency model: requests hold a worker for their processing delay
+    WorkerPool missWorkers;  // Generates responses; also serves hits unless hitWorkers is set
+    WorkerPool hitWorkers;  // Dedicated cache-hit workers (only if separateHitWorkers)
+    bool separateHitWorkers;
+    int requestsDropped;
     
     // Metrics tracking variables
-    std::map<int, simtime_t> requestStartTimes;  // requestId -> start time
+    FlatHashMap<simtime_t> requestStartTimes;  // makeRequestKey(clientId, requestId) -> start time
     int totalCacheHits;
     int totalCacheMisses;
     double totalTimeSaved;
+    double latePrefetchTimeSaved;  // Generation time late prefetch waiters did not wait for
+    bool pageLatencyPercentiles;  // Per-page response time histograms (configurable)
+    std::map<int, HdrHistogram> pageLatency;  // resourceId -> response times, created on first response
     
-    // Random number generation for processing delay
-    std::mt19937 rng;
+    // Random number generation: per-request draws, so paired runs see the same delays
+    RandomStream serviceTimeRng;  // Substream per request: hit delay or generation cost
+    RandomStream prefetchRng;  // Generation costs of prefetches
     std::uniform_real_distribution<double> delayDistribution;
     std::uniform_real_distribution<double> cacheHitDelayDistribution;
     
@@ -82,16 +174,41 @@ private:
     simsignal_t responseGeneratedSignal;
     simsignal_t processingTimeSignal;
     simsignal_t patternLearnedSignal;
+    simsignal_t sessionPredictionSignal;
+    simsignal_t predictionOrderSignal;
     simsignal_t cacheHitSignal;
     simsignal_t cacheMissSignal;
     simsignal_t cachePreGeneratedSignal;
+    simsignal_t pushSentSignal;
+    simsignal_t pushBudgetDeniedSignal;
+    simsignal_t pushDuplicateSignal;
     simsignal_t cacheExpiredSignal;
     simsignal_t cacheEvictedSignal;
+    simsignal_t cacheAdmissionRejectedSignal;
     simsignal_t cacheSizeSignal;
+    simsignal_t cacheBytesSignal;
     simsignal_t responseTimeSignal;
+    simsignal_t hitResponseTimeSignal;
+    simsignal_t missResponseTimeSignal;
     simsignal_t cacheHitRateSignal;
     simsignal_t timeSavingsSignal;
     simsignal_t requestCompleteSignal;
+    simsignal_t queueLengthSignal;
+    simsignal_t queueWaitSignal;
+    simsignal_t busyWorkersSignal;
+    simsignal_t requestDroppedSignal;
+    simsignal_t predictionThresholdSignal;
+    simsignal_t adaptiveCacheTTLSignal;
+    simsignal_t prefetchPrecisionSignal;
+    simsignal_t prefetchUsefulSignal;
+    simsignal_t prefetchWastedSignal;
+    simsignal_t prefetchEvictedUnusedSignal;
+    simsignal_t prefetchBudgetDeniedSignal;
+    simsignal_t prefetchCostSignal;
+    simsignal_t prefetchLateSignal;
+    simsignal_t missCoalescedSignal;
+    simsignal_t notModifiedSignal;
+    simsignal_t decompressionTimeSignal;
 
 protected:
     virtual void initialize() override;
@@ -101,27 +218,47 @@ protected:
     // Helper methods
     virtual void initializeWebPages();
     virtual void handleHttpRequest(HttpRequest *request);
-    virtual void processDelayedRequest(cMessage *delayedMsg);
+    virtual void serveCacheHit(PendingResponse *cachedMsg, double savedCost, double decompressTime = 0.0);
+    virtual void sendCachedResponse(PendingResponse *pending);
+    virtual void processDelayedRequest(PendingResponse *pending);
+    virtual void sendGeneratedResponse(PendingResponse *pending);
     virtual PageInfo* getPageInfo(int pageId);
+    virtual void setCacheHeaders(HttpResponse *response, const PageInfo *pageInfo);
+    virtual double sampleGenerationCost(int resourceId, RandomStream& rng);
+    virtual void recordResponseTime(int resourceId, double responseTime, simsignal_t pathSignal);
+    
+    // Worker pool methods
+    virtual WorkerPool& getWorkerPool(const PendingResponse *job);
+    virtual bool submitJob(PendingResponse *job, simtime_t serviceTime);  // false if the job was dropped or rejected
+    virtual void startJob(WorkerPool& pool, PendingResponse *job, simtime_t serviceTime, simtime_t enqueueTime);
+    virtual void finishJob(PendingResponse *job);
+    virtual void rejectRequest(PendingResponse *job);
+    virtual void transmitResponse(HttpResponse *response, int gateIndex, bool background = false);
+    virtual void completePrefetch(PendingResponse *job);
+    virtual void dropPrefetch(PendingResponse *job);
     virtual std::string generatePageContent(const std::string& pageName);
     
     // Pattern learning methods
-    virtual void updatePatternTable(int clientId, const std::string& fromPage, const std::string& toPage);
-    virtual double calculateTransitionProbability(const std::string& fromPage, const std::string& toPage);
-    virtual std::string getPageName(int pageId);
+    virtual void updatePatternTable(int clientId, int fromPage, int toPage);
+    virtual double calculateTransitionProbability(int fromPage, int toPage);
+    virtual const std::string& getPageName(int pageId);
     virtual void printPatternStatistics();
     
     // Predictive caching methods
-    virtual bool checkResponseCache(const std::string& page, std::string& cachedResponse);
-    virtual void predictivePreCache(const std::string& currentPage);
+    virtual bool checkResponseCache(int resourceId, PageContent& cachedResponse, double& savedCost, double& decompressTime);
+    virtual void compressIfCold(CacheEntry& entry);
+    virtual void predictivePreCache(int clientId, int currentPage, int clientGate = -1);
+    virtual void pushPredictedPages(int clientId, int currentPage, int clientGate, const PatternTable::Predictions& predictions);
+    virtual bool ownsPage(int pageId) const;
     
     // Cache management methods
-    virtual void scheduleCacheExpiry(const std::string& pageName, double ttlSeconds);
-    virtual void handleCacheExpiry(const std::string& pageName);
-    virtual void cleanupExpiredCache();
-    virtual void evictLeastRecentlyUsed();
-    virtual void updateCacheSize();
-    virtual bool addToCacheWithManagement(const std::string& pageName, const CacheEntry& entry);
+    virtual void scheduleCacheExpiry();
+    virtual void handleCacheExpiry();
+    virtual bool addToCacheWithManagement(const CacheEntry& newEntry, double admissionWeight = 1.0);
+    virtual void onCacheRemoval(const CacheEntry& entry, CacheRemovalListener::Cause cause) override;
+    
+    // Adaptive threshold control
+    virtual void handleControllerTick();
 };
 
 Define_Module(HttpServer);
@@ -131,9 +268,13 @@ void HttpServer::initialize()
     // Initialize state variables
     requestsReceived = 0;
     responsesGenerated = 0;
+    visualize = par("visualize").boolValue();
+    verbose = par("verbose").boolValue();
     
-    // Initialize random number generator
-    rng.seed(intuniform(0, 100000));
+    // Initialize random streams from the module-local OMNeT++ RNG - READ FROM PARAMETERS
+    cRNG *serviceRng = getRNG(par("serviceTimeRng").intValue());
+    serviceTimeRng.seed(serviceRng);
+    prefetchRng.seed(serviceRng);
     delayDistribution = std::uniform_real_distribution<double>(0.1, 0.2);  // 100-200ms
     
     // Initialize predictive caching - READ FROM PARAMETERS
@@ -141,120 +282,288 @@ void HttpServer::initialize()
     predictionThreshold = par("predictionThreshold").doubleValue();
     cacheTTL = par("cacheTTL").intValue();
     
+    // Initialize adaptive threshold control - READ FROM PARAMETERS
+    adaptiveThreshold = par("adaptiveThreshold").boolValue();
+    thresholdController.configure(predictionThreshold, par("thresholdMin").doubleValue(), 
+                                  par("thresholdMax").doubleValue(), par("targetPrecision").doubleValue(), 
+                                  par("controllerGain").doubleValue());
+    if (adaptiveThreshold && par("adaptiveCacheTTL").boolValue()) {
+        thresholdController.configureTtl(cacheTTL, par("cacheTTLMin").intValue(), par("cacheTTLMax").intValue());
+    }
+    controllerInterval = par("controllerInterval").doubleValue();
+    controllerTimer = nullptr;
+    intervalRequests = 0;
+    
+    // Initialize prefetch accounting - READ FROM PARAMETERS
+    prefetchBudget.configure(par("prefetchBudget").doubleValue(), par("prefetchBudgetBurst").doubleValue(), simTime());
+    prefetchIssued = 0;
+    prefetchUseful = 0;
+    prefetchExpiredUnused = 0;
+    prefetchEvictedUnused = 0;
+    prefetchBudgetDenied = 0;
+    prefetchWork = 0.0;
+    prefetchLate = 0;
+    prefetchDropped = 0;
+    
+    // Initialize server push - READ FROM PARAMETERS
+    pushCount = par("pushCount").intValue();
+    pushThreshold = par("pushThreshold").doubleValue();
+    pushBudgetRate = par("pushBudget").doubleValue();
+    pushBudgetBurst = par("pushBudgetBurst").doubleValue();
+    if (pushCount < 0 || pushBudgetRate < 0) {
+        throw cRuntimeError("pushCount and pushBudget must not be negative");
+    }
+    pushSent = 0;
+    pushBytes = 0;
+    pushBudgetDenied = 0;
+    pushDuplicates = 0;
+    
+    // Initialize miss handling - READ FROM PARAMETERS
+    coalesceMisses = par("coalesceMisses").boolValue();
+    demandFill = par("demandFill").boolValue();
+    missesCoalesced = 0;
+    responseMaxAge = par("responseMaxAge").intValue();
+    notModifiedSent = 0;
+    
+    if (adaptiveThreshold) {
+        if (controllerInterval <= SIMTIME_ZERO) {
+            throw cRuntimeError("controllerInterval must be positive");
+        }
+        predictionThreshold = thresholdController.getThreshold();
+        controllerTimer = new cMessage("ControllerTick", SERVER_CONTROLLER_TICK);
+        scheduleAt(simTime() + controllerInterval, controllerTimer);
+    }
+    
     // Initialize cache management - READ FROM PARAMETERS
     maxCacheSize = par("maxCacheSize").intValue();
-    currentCacheSize = 0;
-    cacheCleanupInterval = 10.0;  // Cleanup every 10 seconds
-    cacheCleanupTimer = new cMessage("CacheCleanup");
-    scheduleAt(simTime() + cacheCleanupInterval, cacheCleanupTimer);
+    responseCache.setCapacity(maxCacheSize);
+    maxCacheBytes = par("maxCacheBytes").intValue();
+    if (maxCacheBytes < 0) {
+        throw cRuntimeError("maxCacheBytes must not be negative");
+    }
+    responseCache.setByteCapacity(maxCacheBytes);
+    responseCache.setRemovalListener(this);
+    responseCache.setPolicy(EvictionPolicy::create(par("evictionPolicy").stdstringValue(), maxCacheSize));
+    
+    std::string admissionPolicy = par("admissionPolicy").stdstringValue();
+    if (admissionPolicy == "tinylfu") {
+        responseCache.setAdmissionFilter(new AdmissionFilter(maxCacheSize));
+    } else if (admissionPolicy != "none") {
+        throw cRuntimeError("Unknown admissionPolicy '%s' (expected none or tinylfu)", admissionPolicy.c_str());
+    }
+    cacheExpiryTimer = new cMessage("CacheExpiry", SERVER_CACHE_EXPIRY);  // Scheduled when the first entry is cached
+    
+    // Initialize compressed storage tier - READ FROM PARAMETERS
+    cacheCodec.configure(par("compressionCodec").stdstringValue(), par("compressionRatio").doubleValue(),
+                         par("decompressionRate").doubleValue(), par("decompressionOverhead").doubleValue());
+    compressMinSize = par("compressMinSize").intValue();
+    compressHotHits = par("compressHotHits").intValue();
+    compressedInserts = 0;
+    decompressions = 0;
+    compressionPromotions = 0;
+    totalDecompressionTime = 0.0;
+    
+    // Initialize output links - READ FROM PARAMETERS
+    responseFormat.headerBytes = par("responseHeaderBytes").intValue();
+    responseFormat.mss = par("mss").intValue();
+    responseFormat.segmentOverhead = par("segmentOverhead").intValue();
+    chunkSize = par("chunkSize").intValue();
+    if (responseFormat.mss <= 0 || chunkSize < 0) {
+        throw cRuntimeError("mss must be positive and chunkSize must not be negative");
+    }
+    simsignal_t txQueueingDelaySignal = registerSignal("txQueueingDelay");
+    txQueues.resize(gateSize("out"));
+    for (int i = 0; i < (int)txQueues.size(); i++) {
+        txQueues[i].init(this, gate("out", i), txQueueingDelaySignal);
+    }
+    
+    // Initialize worker pools - READ FROM PARAMETERS
+    std::string queueDiscipline = par("queueDiscipline").stdstringValue();
+    missWorkers.configure(par("numWorkers").intValue(), par("queueCapacity").intValue(), queueDiscipline);
+    int hitWorkerCount = par("hitWorkers").intValue();
+    separateHitWorkers = (hitWorkerCount >= 0);
+    if (separateHitWorkers) {
+        hitWorkers.configure(hitWorkerCount, par("queueCapacity").intValue(), queueDiscipline);
+    }
+    requestsDropped = 0;
+    
+    // Learn into our own pattern table unless shards share one
+    patternTable = &ownPatternTable;
+    std::string sharedPatternTablePath = par("sharedPatternTable").stdstringValue();
+    if (!sharedPatternTablePath.empty()) {
+        cModule *sharedModule = getModuleByPath(sharedPatternTablePath.c_str());
+        if (!sharedModule) {
+            throw cRuntimeError("sharedPatternTable module '%s' not found", sharedPatternTablePath.c_str());
+        }
+        patternTable = check_and_cast<SharedPatternTable*>(sharedModule)->getTable();
+    }
+    
+    // Under consistent-hash routing, rebuild the load balancer's ring to know which pages are ours
+    shardIndex = par("shardIndex").intValue();
+    int numShards = par("numShards").intValue();
+    if (shardIndex >= numShards) {
+        throw cRuntimeError("shardIndex %d out of range for %d shards", shardIndex, numShards);
+    }
+    if (shardIndex >= 0) {
+        shardRing.setVirtualNodes(par("virtualNodes").intValue());
+        shardRing.build(numShards);
+    }
+    
+    // Exponentially decayed transition counts, pruned within the pattern budget
+    double patternHalfLife = par("patternHalfLife").doubleValue();
+    int maxPatterns = par("maxPatterns").intValue();
+    if (patternHalfLife < 0 || maxPatterns < 0) {
+        throw cRuntimeError("patternHalfLife and maxPatterns must not be negative");
+    }
+    patternTable->setDecay(patternHalfLife, maxPatterns);
+    
+    // Warm start from the previous run's snapshot
+    patternSnapshotFile = par("patternSnapshotFile").stdstringValue();
+    ownsPatternSnapshot = (patternTable == &ownPatternTable || getIndex() == 0);
+    savePatternSnapshot = par("savePatternSnapshot").boolValue();
+    if (!patternSnapshotFile.empty() && ownsPatternSnapshot) {
+        if (patternTable->loadSnapshot(patternSnapshotFile)) {
+            EV << "Pattern table warm-started from " << patternSnapshotFile << ": " 
+               << patternTable->getPatternCount() << " patterns" << endl;
+        } else {
+            EV << "WARNING: Pattern snapshot " << patternSnapshotFile 
+               << " missing or invalid, starting with an empty table" << endl;
+        }
+    }
+    
+    // Initialize next-page predictor
+    std::string predictorName = par("predictor").stdstringValue();
+    if (predictorName == "global") {
+        predictorMode = PREDICT_GLOBAL;
+    } else if (predictorName == "session") {
+        predictorMode = PREDICT_SESSION;
+    } else if (predictorName == "ppm") {
+        predictorMode = PREDICT_PPM;
+    } else {
+        throw cRuntimeError("Unknown predictor '%s' (expected global, session or ppm)", predictorName.c_str());
+    }
+    sessionPredictor.configure(par("sessionHistoryLength").intValue(), par("sessionMinSupport").intValue());
+    if (predictorMode == PREDICT_PPM) {
+        int ppmMaxOrder = par("ppmMaxOrder").intValue();
+        if (ppmMaxOrder > sessionPredictor.getHistoryLength()) {
+            throw cRuntimeError("ppmMaxOrder (%d) must not exceed sessionHistoryLength (%d)", 
+                                ppmMaxOrder, sessionPredictor.getHistoryLength());
+        }
+        patternTable->setContextModel(ppmMaxOrder, par("ppmMaxNodes").intValue(), par("ppmMinSupport").intValue());
+    }
     
     // Initialize web pages
     initializeWebPages();
     
     // Set initial server display
-    getDisplayString().setTagArg("i", 1, "gold");
-    getDisplayString().setTagArg("t", 0, "HTTP Server\nPredictive Cache\nReady");
+    IF_VISUALIZE {
+        getDisplayString().setTagArg("i", 1, "gold");
+        getDisplayString().setTagArg("t", 0, "HTTP Server\nPredictive Cache\nReady");
+    }
     
     // Register signals for statistics
     requestReceivedSignal = registerSignal("requestReceived");
     responseGeneratedSignal = registerSignal("responseGenerated");
     processingTimeSignal = registerSignal("processingTime");
     patternLearnedSignal = registerSignal("patternLearned");
+    sessionPredictionSignal = registerSignal("sessionPrediction");
+    predictionOrderSignal = registerSignal("predictionOrder");
     cacheHitSignal = registerSignal("cacheHit");
     cacheMissSignal = registerSignal("cacheMiss");
     cachePreGeneratedSignal = registerSignal("cachePreGenerated");
+    pushSentSignal = registerSignal("pushSent");
+    pushBudgetDeniedSignal = registerSignal("pushBudgetDenied");
+    pushDuplicateSignal = registerSignal("pushDuplicate");
     cacheExpiredSignal = registerSignal("cacheExpired");
     cacheEvictedSignal = registerSignal("cacheEvicted");
+    cacheAdmissionRejectedSignal = registerSignal("cacheAdmissionRejected");
     cacheSizeSignal = registerSignal("cacheSize");
+    cacheBytesSignal = registerSignal("cacheBytes");
     responseTimeSignal = registerSignal("responseTime");
+    hitResponseTimeSignal = registerSignal("hitResponseTime");
+    missResponseTimeSignal = registerSignal("missResponseTime");
     cacheHitRateSignal = registerSignal("cacheHitRate");
     timeSavingsSignal = registerSignal("timeSavings");
     requestCompleteSignal = registerSignal("requestComplete");
+    queueLengthSignal = registerSignal("queueLength");
+    queueWaitSignal = registerSignal("queueWait");
+    busyWorkersSignal = registerSignal("busyWorkers");
+    requestDroppedSignal = registerSignal("requestDropped");
+    predictionThresholdSignal = registerSignal("predictionThreshold");
+    adaptiveCacheTTLSignal = registerSignal("adaptiveCacheTTL");
+    prefetchPrecisionSignal = registerSignal("prefetchPrecision");
+    prefetchUsefulSignal = registerSignal("prefetchUseful");
+    prefetchWastedSignal = registerSignal("prefetchWasted");
+    prefetchEvictedUnusedSignal = registerSignal("prefetchEvictedUnused");
+    prefetchBudgetDeniedSignal = registerSignal("prefetchBudgetDenied");
+    prefetchCostSignal = registerSignal("prefetchCost");
+    prefetchLateSignal = registerSignal("prefetchLate");
+    missCoalescedSignal = registerSignal("missCoalesced");
+    notModifiedSignal = registerSignal("notModified");
+    decompressionTimeSignal = registerSignal("decompressionTime");
     
     // Initialize metrics tracking
     totalCacheHits = 0;
     totalCacheMisses = 0;
     totalTimeSaved = 0.0;
+    latePrefetchTimeSaved = 0.0;
+    pageLatencyPercentiles = par("pageLatencyPercentiles").boolValue();  // READ FROM PARAMETERS
     
     EV << "HttpServer initialized with " << webPages.size() << " web pages" << endl;
     EV << "Configuration: predictionThreshold=" << predictionThreshold 
-       << ", cacheTTL=" << cacheTTL << "s, maxCacheSize=" << maxCacheSize << endl;
+       << ", cacheTTL=" << cacheTTL << "s, maxCacheSize=" << maxCacheSize 
+       << ", maxCacheBytes=" << maxCacheBytes 
+       << ", compressionCodec=" << cacheCodec.getName() 
+       << ", evictionPolicy=" << responseCache.getPolicyName() 
+       << ", admissionPolicy=" << admissionPolicy 
+       << ", predictor=" << predictorName << endl;
+    EV << "Workers: numWorkers=" << missWorkers.getNumWorkers() 
+       << ", queueCapacity=" << missWorkers.getQueueCapacity() 
+       << ", queueDiscipline=" << queueDiscipline 
+       << ", hitWorkers=" << (separateHitWorkers ? std::to_string(hitWorkers.getNumWorkers()) : std::string("shared")) << endl;
     EV << "Pages available: ";
-    for (const auto& page : webPages) {
-        EV << page.second.pageName << " ";
+    int listed = 0;
+    for (const PageInfo& page : webPages.getPages()) {
+        if (page.pageId < 0) {
+            continue;
+        }
+        if (++listed > 10) {
+            EV << "... ";
+            break;
+        }
+        EV << page.pageName << " ";
     }
-    EV << endl;
+    EV << "(" << webPages.size() << " pages, " << webPages.getTotalBytes() << " bytes)" << endl;
 }
 
 void HttpServer::handleMessage(cMessage *msg)
 {
     if (msg->isSelfMessage()) {
-        // Check message type for different self-messages
-        if (strcmp(msg->getName(), "CachedResponse") == 0) {
-            // Handle cached response
-            int requestId = msg->par("requestId");
-            int clientId = msg->par("clientId");
-            int resourceId = msg->par("resourceId");
-            int fromPage = msg->par("fromPage");
-            int arrivalGate = msg->par("arrivalGate");
-            const char* content = msg->par("content");
-            
-            // Create and send cached response
-            HttpResponse *response = new HttpResponse("HttpResponse");
-            response->setRequestId(requestId);
-            response->setResourceId(resourceId);
-            response->setContent(content);
-            response->setTimestamp(simTime());
-            response->setTtl(3600);
-            response->setCacheable(true);
-            
-            send(response, "out", arrivalGate);
-
-            // Reset color to gold after processing cached response
-            getDisplayString().setTagArg("i", 1, "gold");
-
-            responsesGenerated++;
-            emit(responseGeneratedSignal, responsesGenerated);
-            
-            // Calculate and emit response time
-            auto startTimeIt = requestStartTimes.find(requestId);
-            if (startTimeIt != requestStartTimes.end()) {
-                double responseTime = SIMTIME_DBL(simTime() - startTimeIt->second);
-                emit(responseTimeSignal, responseTime);
-                requestStartTimes.erase(startTimeIt);
-                emit(requestCompleteSignal, 1);
-                
-                EV << "Response time for cached request " << requestId << ": " << responseTime << "s" << endl;
-            }
-            
-            // Pattern learning for cached requests too
-            std::string currentPageName = getPageName(resourceId);
-            std::string fromPageName = getPageName(fromPage);
-            
-            if (fromPage >= 0) {  // Valid fromPage
-                updatePatternTable(clientId, fromPageName, currentPageName);
-            }
-            
-            // Trigger predictive pre-caching
-            predictivePreCache(currentPageName);
-            
-            EV << "Sent cached response for page '" << currentPageName 
-               << "' to client " << clientId << endl;
-               
-            delete msg;
-        } else if (strcmp(msg->getName(), "CacheCleanup") == 0) {
-            // Periodic cache cleanup
-            cleanupExpiredCache();
-            // Reschedule next cleanup
-            scheduleAt(simTime() + cacheCleanupInterval, cacheCleanupTimer);
-        } else if (strncmp(msg->getName(), "CacheExpiry_", 12) == 0) {
-            // Individual cache entry expiry
-            std::string pageName = msg->getName() + 12;  // Extract page name after "CacheExpiry_"
-            handleCacheExpiry(pageName);
-            delete msg;
-        } else {
-            // This is a delayed processing message
-            processDelayedRequest(msg);
+        // Self-messages are dispatched by kind; PendingResponse kinds are set by this module
+        switch (msg->getKind()) {
+            case SERVER_CACHED_RESPONSE:
+                sendCachedResponse(static_cast<PendingResponse*>(msg));
+                break;
+            case SERVER_DELAYED_PROCESSING:
+                processDelayedRequest(static_cast<PendingResponse*>(msg));
+                break;
+            case SERVER_PREFETCH_COMPLETE:
+                completePrefetch(check_and_cast<PendingResponse*>(msg));
+                break;
+            case SERVER_CONTROLLER_TICK:
+                handleControllerTick();
+                break;
+            case SERVER_CACHE_EXPIRY:
+                // Earliest cache entry (and any others due now) expired
+                handleCacheExpiry();
+                break;
+            case TransmissionQueue::TIMER_KIND:
+                TransmissionQueue::handleTimer(msg);
+                break;
+            default:
+                EV << "ERROR: Unknown self-message kind " << msg->getKind() << endl;
+                delete msg;
+                break;
         }
     } else {
         // This is an incoming HTTP request
@@ -268,28 +577,343 @@ void HttpServer::handleMessage(cMessage *msg)
     }
 }
 
-void HttpServer::initializeWebPages()
+void HttpServer::serveCacheHit(PendingResponse *cachedMsg, double savedCost, double decompressTime)
 {
-    // Initialize the 6 web pages with realistic content
-    webPages[HOME] = PageInfo(HOME, "home", 
-        generatePageContent("Home"), 3600);
-        
-    webPages[LOGIN] = PageInfo(LOGIN, "login", 
-        generatePageContent("Login"), 1800);
+    // Cache hit - serve from cache with reduced delay (plus decoding a compressed entry)
+    const std::string& pageName = getPageName(cachedMsg->getResourceId());
+    RandomStream requestRng = serviceTimeRng.substream(cachedMsg->getRequestKey());
+    double cacheDelay = cacheHitDelayDistribution(requestRng) + decompressTime;
+    if (decompressTime > 0) {
+        totalDecompressionTime += decompressTime;
+        emit(decompressionTimeSignal, decompressTime);
+    }
+    emit(processingTimeSignal, cacheDelay);
+    
+    LOG_EV << "Cache HIT for page '" << pageName << "' - serving with " << cacheDelay << "s delay" << endl;
+    
+    // Visual feedback for cache hit
+    IF_VISUALIZE {
+        getDisplayString().setTagArg("i", 1, "green");
+        std::string bubbleText = "CACHE HIT \n" + pageName;
+        bubble(bubbleText.c_str());
+    }
+    
+    // Update cache hit metrics
+    totalCacheHits++;
+    emit(cacheHitSignal, 1);
+    
+    // Calculate time savings (generation cost of the cached content - cache delay)
+    double timeSaved = savedCost - cacheDelay;
+    totalTimeSaved += timeSaved;
+    emit(timeSavingsSignal, timeSaved);
+    
+    // Update cache hit rate
+    double hitRate = (double)totalCacheHits / (totalCacheHits + totalCacheMisses) * 100.0;
+    emit(cacheHitRateSignal, hitRate);
+    
+    submitJob(cachedMsg, cacheDelay);
+}
+
+void HttpServer::sendCachedResponse(PendingResponse *pending)
+{
+    finishJob(pending);
+    
+    int requestId = pending->getRequestId();
+    int clientId = pending->getClientId();
+    int resourceId = pending->getResourceId();
+    int fromPage = pending->getFromPage();
+    
+    // Create and send cached response (it shares the cached body); a 304 carries no body
+    HttpResponse *response = new HttpResponse("HttpResponse");
+    response->setRequestId(requestId);
+    response->setClientId(clientId);
+    response->setResourceId(resourceId);
+    if (pending->isNotModified()) {
+        response->setStatusCode(304);
+    } else {
+        response->setContent(pending->getContent());
+        if (pending->getResponseSize() > 0) {
+            response->setContentSize(pending->getResponseSize());  // Replayed trace: the logged size
+        }
+    }
+    response->setTimestamp(simTime());
+    setCacheHeaders(response, getPageInfo(resourceId));
+    
+    transmitResponse(response, pending->getArrivalGateIndex());
+    
+    // Reset color to gold after processing cached response
+    IF_VISUALIZE getDisplayString().setTagArg("i", 1, "gold");
+    
+    responsesGenerated++;
+    emit(responseGeneratedSignal, responsesGenerated);
+    
+    // Calculate and emit response time
+    simtime_t startTime;
+    if (requestStartTimes.take(pending->getRequestKey(), startTime)) {
+        double responseTime = SIMTIME_DBL(simTime() - startTime);
+        recordResponseTime(resourceId, responseTime, hitResponseTimeSignal);
+        emit(requestCompleteSignal, 1);
         
-    webPages[DASHBOARD] = PageInfo(DASHBOARD, "dashboard", 
-        generatePageContent("Dashboard"), 900);
+        LOG_EV << "Response time for cached request " << requestId << ": " << responseTime << "s" << endl;
+    }
+    
+    // Pattern learning for cached requests too
+    updatePatternTable(clientId, fromPage, resourceId);
+    
+    // Trigger predictive pre-caching (and push to this client)
+    predictivePreCache(clientId, resourceId, pending->getArrivalGateIndex());
+    
+    LOG_EV << "Sent cached response for page '" << getPageName(resourceId) 
+       << "' to client " << clientId << endl;
+    
+    delete pending;
+}
+
+WorkerPool& HttpServer::getWorkerPool(const PendingResponse *job)
+{
+    if (separateHitWorkers && job->getKind() == SERVER_CACHED_RESPONSE) {
+        return hitWorkers;
+    }
+    return missWorkers;
+}
+
+bool HttpServer::submitJob(PendingResponse *job, simtime_t serviceTime)
+{
+    WorkerPool& pool = getWorkerPool(job);
+    job->setServiceTime(SIMTIME_DBL(serviceTime));
+    
+    if (pool.hasIdleWorker()) {
+        startJob(pool, job, serviceTime, simTime());
+        return true;
+    }
+    
+    // All workers busy: cache hits are cheap, so they go first under the priority discipline;
+    // background prefetches only get workers no demand request is waiting for, under either discipline
+    int priority = 1;
+    if (job->getKind() == SERVER_CACHED_RESPONSE) {
+        priority = 0;
+    } else if (job->getKind() == SERVER_PREFETCH_COMPLETE) {
+        priority = WorkerPool::BACKGROUND_PRIORITY;
+    }
+    
+    if (pool.enqueue(job, serviceTime, priority, simTime())) {
+        emit(queueLengthSignal, pool.getQueueLength());
+        LOG_EV << "All " << pool.getNumWorkers() << " workers busy, job " << job->getName() 
+           << " for page " << job->getResourceId() << " queued (queue length " << pool.getQueueLength() << ")" << endl;
+        return true;
+    }
+    if (job->getKind() == SERVER_PREFETCH_COMPLETE) {
+        dropPrefetch(job);
+    } else {
+        rejectRequest(job);
+    }
+    return false;
+}
+
+void HttpServer::startJob(WorkerPool& pool, PendingResponse *job, simtime_t serviceTime, simtime_t enqueueTime)
+{
+    pool.acquire();
+    if (job->getKind() != SERVER_PREFETCH_COMPLETE) {
+        emit(queueWaitSignal, SIMTIME_DBL(simTime() - enqueueTime));  // Demand requests only
+    }
+    emit(busyWorkersSignal, pool.getBusyWorkers());
+    scheduleAt(simTime() + serviceTime, job);
+}
+
+void HttpServer::transmitResponse(HttpResponse *response, int gateIndex, bool background)
+{
+    int contentSize = response->getContentSize();
+    if (chunkSize <= 0 || contentSize <= chunkSize) {
+        response->setByteLength(responseFormat.messageBytes(contentSize));
+        txQueues[gateIndex].send(response, background);
+        return;
+    }
+    
+    // Chunked transfer coding: the headers travel with the first chunk
+    int numChunks = (contentSize + chunkSize - 1) / chunkSize;
+    for (int i = 0; i < numChunks; i++) {
+        bool last = (i == numChunks - 1);
+        int64_t chunkBytes = std::min<int64_t>(chunkSize, contentSize - (int64_t)i * chunkSize);
+        int64_t payload = chunkBytes + WireFormat::chunkFraming(chunkBytes, last) + (i == 0 ? responseFormat.headerBytes : 0);
         
-    webPages[PROFILE] = PageInfo(PROFILE, "profile", 
-        generatePageContent("Profile"), 1800);
+        HttpResponse *chunk = last ? response : response->dup();
+        chunk->setChunk(i, numChunks);
+        chunk->setByteLength(responseFormat.framed(payload));
+        txQueues[gateIndex].send(chunk, background);
+    }
+}
+
+void HttpServer::finishJob(PendingResponse *job)
+{
+    // Free the worker and hand it the next queued job
+    WorkerPool& pool = getWorkerPool(job);
+    pool.release();
+    
+    if (pool.hasQueuedJob()) {
+        WorkerPool::Job next = pool.dequeue();
+        emit(queueLengthSignal, pool.getQueueLength());
+        startJob(pool, next.msg, next.serviceTime, next.enqueueTime);
+    } else {
+        emit(busyWorkersSignal, pool.getBusyWorkers());
+    }
+}
+
+void HttpServer::rejectRequest(PendingResponse *job)
+{
+    // Queue full: answer immediately so the client's request loop keeps going
+    LOG_EV << "Queue full, dropping request " << job->getRequestId() 
+       << " from client " << job->getClientId() << endl;
+    
+    // A refused miss cannot lead a generation (submitted synchronously, so nobody waits yet)
+    auto generation = inFlight.find(job->getResourceId());
+    if (generation != inFlight.end() && generation->second.job == job) {
+        inFlight.erase(generation);
+    }
+    
+    HttpResponse *busyResponse = new HttpResponse("HttpResponse");
+    busyResponse->setRequestId(job->getRequestId());
+    busyResponse->setClientId(job->getClientId());
+    busyResponse->setResourceId(job->getResourceId());
+    busyResponse->setContent("ERROR 503: Service unavailable");
+    busyResponse->setStatusCode(503);
+    busyResponse->setTimestamp(simTime());
+    busyResponse->setTtl(0);
+    busyResponse->setCacheable(false);
+    
+    transmitResponse(busyResponse, job->getArrivalGateIndex());
+    
+    requestsDropped++;
+    emit(requestDroppedSignal, 1);
+    requestStartTimes.erase(job->getRequestKey());  // Dropped requests are not part of the response time
+    
+    delete job;
+}
+
+void HttpServer::completePrefetch(PendingResponse *job)
+{
+    finishJob(job);
+    
+    int resourceId = job->getResourceId();
+    const std::string& pageName = getPageName(resourceId);
+    auto it = inFlight.find(resourceId);
+    InFlightGeneration generation;
+    if (it != inFlight.end()) {
+        generation.probability = it->second.probability;
+        generation.cost = it->second.cost;
+        generation.waiters.swap(it->second.waiters);
+        inFlight.erase(it);
+    }
+    delete job;
+    
+    PageInfo* pageInfo = getPageInfo(resourceId);
+    if (!pageInfo) {
+        EV << "ERROR: Prefetched resource " << resourceId << " not found!" << endl;
         
-    webPages[SETTINGS] = PageInfo(SETTINGS, "settings", 
-        generatePageContent("Settings"), 1200);
+        // The waiters still need an answer: each gets the 404
+        for (PendingResponse *waiter : generation.waiters) {
+            sendGeneratedResponse(waiter);
+        }
+        return;
+    }
+    
+    // The generated response becomes visible in the cache only now
+    CacheEntry cacheEntry(resourceId, pageInfo->content, cacheTTL);
+    cacheEntry.setTimestamp(simTime());
+    cacheEntry.setProvenance(CacheEntry::PREFETCHED);
+    cacheEntry.setGenerationCost(generation.cost);
+    
+    // Late requests already used the result, so the prefetch was useful
+    for (size_t i = 0; i < generation.waiters.size(); i++) {
+        cacheEntry.recordHit();
+    }
+    if (!generation.waiters.empty()) {
+        prefetchUseful++;
+        emit(prefetchUsefulSignal, 1);
+        thresholdController.recordUseful();
+    }
+    
+    // Use cache management system to add entry (also schedules its expiry);
+    // the prediction probability weighs the page against the eviction victim
+    if (addToCacheWithManagement(cacheEntry, generation.probability)) {
+        LOG_EV << "Pre-cached response for page '" << pageName 
+           << "' (probability: " << std::fixed << std::setprecision(3) 
+           << generation.probability << ", TTL: " << cacheTTL << "s)" << endl;
         
-    webPages[LOGOUT] = PageInfo(LOGOUT, "logout", 
-        generatePageContent("Logout"), 300);
+        // Visual feedback for predictive caching
+        IF_VISUALIZE {
+            getDisplayString().setTagArg("i", 1, "cyan");
+            std::string bubbleText = "Pre-cache \n" + pageName + " " + std::to_string((int)(generation.probability*100)) + "%";
+            bubble(bubbleText.c_str());
+        }
         
-    EV << "Initialized " << webPages.size() << " web pages" << endl;
+        emit(cachePreGeneratedSignal, 1);
+    } else {
+        LOG_EV << "Pre-cache of page '" << pageName << "' rejected by admission filter" << endl;
+    }
+    
+    // Serve the waiting requests like the misses they were counted as; each saved the part
+    // of the generation it did not wait for (nothing if the prefetch was still queued)
+    for (PendingResponse *waiter : generation.waiters) {
+        simtime_t *startTime = requestStartTimes.find(waiter->getRequestKey());
+        if (startTime) {
+            latePrefetchTimeSaved += std::max(0.0, generation.cost - SIMTIME_DBL(simTime() - *startTime));
+        }
+        sendGeneratedResponse(waiter);
+    }
+}
+
+void HttpServer::dropPrefetch(PendingResponse *job)
+{
+    // Worker queue full: prefetching is optional work, so it is simply skipped
+    LOG_EV << "Queue full, dropping prefetch of page '" << getPageName(job->getResourceId()) << "'" << endl;
+    
+    // Submitted synchronously, so nobody waits yet; the work was never done, so its budget comes back
+    auto it = inFlight.find(job->getResourceId());
+    if (it != inFlight.end()) {
+        prefetchBudget.refund(it->second.cost, simTime());
+        inFlight.erase(it);
+    }
+    prefetchDropped++;
+    delete job;
+}
+
+void HttpServer::initializeWebPages()
+{
+    // A catalog file replaces the built-in pages - READ FROM PARAMETERS
+    std::string catalogFile = par("catalogFile").stdstringValue();
+    if (!catalogFile.empty()) {
+        // The catalog describes the site, not this server: every shard derives the same
+        // pages from the file name and the seed set alone
+        uint64_t seedSet = std::strtoull(getEnvir()->getConfigEx()->getVariable(CFGVAR_SEEDSET), nullptr, 10);
+        uint64_t catalogSeed = (static_cast<uint64_t>(hashContentBytes(catalogFile.data(), catalogFile.size())) << 32) ^ seedSet;
+        webPages.load(catalogFile, catalogSeed);
+        if (webPages.empty()) {
+            throw cRuntimeError("Page catalog '%s' defines no pages", catalogFile.c_str());
+        }
+        EV << "Loaded " << webPages.size() << " pages from " << catalogFile << endl;
+        return;
+    }
+    
+    // Initialize the 6 web pages with realistic content (each body is built once)
+    webPages.add(PageInfo(HOME, "home", 
+        makePageContent(generatePageContent("Home")), 3600));
+    
+    webPages.add(PageInfo(LOGIN, "login", 
+        makePageContent(generatePageContent("Login")), 1800));
+    
+    webPages.add(PageInfo(DASHBOARD, "dashboard", 
+        makePageContent(generatePageContent("Dashboard")), 900));
+    
+    webPages.add(PageInfo(PROFILE, "profile", 
+        makePageContent(generatePageContent("Profile")), 1800));
+    
+    webPages.add(PageInfo(SETTINGS, "settings", 
+        makePageContent(generatePageContent("Settings")), 1200));
+    
+    webPages.add(PageInfo(LOGOUT, "logout", 
+        makePageContent(generatePageContent("Logout")), 300));
+    
+    LOG_EV << "Initialized " << webPages.size() << " web pages" << endl;
 }
 
 void HttpServer::handleHttpRequest(HttpRequest *request)
@@ -297,73 +921,95 @@ void HttpServer::handleHttpRequest(HttpRequest *request)
     requestsReceived++;
     emit(requestReceivedSignal, requestsReceived);
     
-    EV << "Received HTTP request from client " << request->getClientId() 
+    LOG_EV << "Received HTTP request from client " << request->getClientId() 
        << " for resource " << request->getResourceId() 
        << " (request ID: " << request->getRequestId() << ")" << endl;
     
     // Record request start time for response time calculation
-    requestStartTimes[request->getRequestId()] = simTime();
-    
-    // Check cache first
-    std::string pageName = getPageName(request->getResourceId());
-    std::string cachedResponse;
+    requestStartTimes[request->getRequestKey()] = simTime();
+    
+    // Demand frequency feeds the eviction policy and the admission filter
+    responseCache.recordRequest(request->getResourceId());
+    intervalRequests++;
+    
+    // The client asks for a page it was pushed and should still hold: that push was wasted
+    if (pushCount > 0) {
+        simtime_t pushExpiry;
+        if (pushedUntil.take(makeRequestKey(request->getClientId(), request->getResourceId()), pushExpiry) &&
+            pushExpiry > simTime()) {
+            pushDuplicates++;
+            emit(pushDuplicateSignal, 1);
+        }
+    }
     
-    if (checkResponseCache(pageName, cachedResponse)) {
-        // Cache hit - serve from cache with reduced delay
-        double cacheDelay = cacheHitDelayDistribution(rng);
-        emit(processingTimeSignal, cacheDelay);
+    // Revalidation of a client copy that is still current: a bodiless 304 at hit cost
+    PageInfo* requested = getPageInfo(request->getResourceId());
+    if (request->isConditional() && requested &&
+        (request->getIfNoneMatch() ? request->getIfNoneMatch() == requested->etag
+                                   : request->getIfModifiedSince() >= requested->lastModified)) {
+        PendingResponse *notModified = new PendingResponse("NotModified", SERVER_CACHED_RESPONSE);
+        notModified->setRequest(request);
+        notModified->setNotModified(true);
+        notModifiedSent++;
+        emit(notModifiedSignal, 1);
         
-        EV << "Cache HIT for page '" << pageName << "' - serving with " << cacheDelay << "s delay" << endl;
+        LOG_EV << "Client copy of page '" << requested->pageName << "' is current, answering 304" << endl;
+        RandomStream requestRng = serviceTimeRng.substream(notModified->getRequestKey());
+        submitJob(notModified, cacheHitDelayDistribution(requestRng));
+        delete request;
+        return;
+    }
+    
+    // Check cache first
+    const std::string& pageName = getPageName(request->getResourceId());
+    PageContent cachedResponse;
+    double savedCost = 0.0;
+    double decompressTime = 0.0;
+    
+    if (checkResponseCache(request->getResourceId(), cachedResponse, savedCost, decompressTime)) {
+        // Schedule sending the cached response (shares the cached body, no copy)
+        PendingResponse *cachedMsg = new PendingResponse("CachedResponse", SERVER_CACHED_RESPONSE);
+        cachedMsg->setRequest(request);
+        cachedMsg->setContent(cachedResponse);
         
-        // Visual feedback for cache hit
-        getDisplayString().setTagArg("i", 1, "green");
-        std::string bubbleText = "CACHE HIT \n" + pageName;
-        bubble(bubbleText.c_str());
+        serveCacheHit(cachedMsg, savedCost, decompressTime);
+        delete request;
+        return;
+    }
+    
+    // A prefetch of this page is still being generated: wait for it instead of generating again
+    auto generation = inFlight.find(request->getResourceId());
+    if (generation != inFlight.end() && generation->second.prefetch) {
+        PendingResponse *waiter = new PendingResponse("DelayedProcessing", SERVER_DELAYED_PROCESSING);
+        waiter->setRequest(request);
+        generation->second.waiters.push_back(waiter);
         
-        // Update cache hit metrics
-        totalCacheHits++;
-        emit(cacheHitSignal, 1);
+        // The page was not in the cache when asked for: a miss, however soon the prefetch lands
+        totalCacheMisses++;
+        emit(cacheMissSignal, 1);
+        emit(cacheHitRateSignal, (double)totalCacheHits / (totalCacheHits + totalCacheMisses) * 100.0);
         
-        // Calculate time savings (normal delay - cache delay)
-        double normalDelay = (delayDistribution.min() + delayDistribution.max()) / 2.0; // Average normal delay
-        double timeSaved = normalDelay - cacheDelay;
-        totalTimeSaved += timeSaved;
-        emit(timeSavingsSignal, timeSaved);
+        // Someone is waiting now: a still queued prefetch is served like a miss
+        getWorkerPool(generation->second.job).raisePriority(generation->second.job, 1);
         
-        // Update cache hit rate
-        double hitRate = (double)totalCacheHits / (totalCacheHits + totalCacheMisses) * 100.0;
-        emit(cacheHitRateSignal, hitRate);
+        prefetchLate++;
+        emit(prefetchLateSignal, 1);
+        LOG_EV << "Late prefetch: request for page '" << pageName 
+           << "' waits for its prefetch to finish" << endl;
         
-        // Create response from cache
-        HttpResponse *response = new HttpResponse("HttpResponse");
-        response->setRequestId(request->getRequestId());
-        response->setResourceId(request->getResourceId());
-        response->setContent(cachedResponse);
-        response->setTimestamp(simTime() + cacheDelay);
-        response->setTtl(3600);
-        response->setCacheable(true);
-        
-        // Schedule sending the cached response
-        cMessage *cachedMsg = new cMessage("CachedResponse");
-        cachedMsg->addPar("requestId") = request->getRequestId();
-        cachedMsg->addPar("clientId") = request->getClientId();
-        cachedMsg->addPar("resourceId") = request->getResourceId();
-        cachedMsg->addPar("fromPage") = request->getFromPage();
-        cachedMsg->addPar("arrivalGate") = request->getArrivalGate()->getIndex();
-        cachedMsg->addPar("content") = cachedResponse.c_str();
-        
-        scheduleAt(simTime() + cacheDelay, cachedMsg);
         delete request;
         return;
     }
     
     // Cache miss - generate normal processing delay (100-200ms)
-    EV << "Cache MISS for page '" << pageName << "' - processing normally" << endl;
+    LOG_EV << "Cache MISS for page '" << pageName << "' - processing normally" << endl;
     
     // Visual feedback for cache miss
-    getDisplayString().setTagArg("i", 1, "red");
-    std::string bubbleText = "CACHE MISS \n" + pageName;
-    bubble(bubbleText.c_str());
+    IF_VISUALIZE {
+        getDisplayString().setTagArg("i", 1, "red");
+        std::string bubbleText = "CACHE MISS \n" + pageName;
+        bubble(bubbleText.c_str());
+    }
     
     // Update cache miss metrics
     totalCacheMisses++;
@@ -375,40 +1021,90 @@ void HttpServer::handleHttpRequest(HttpRequest *request)
     emit(cacheHitRateSignal, hitRate);
     
     // Update display with current statistics
-    std::string statusText = "HTTP Server\nCache: " + std::to_string(currentCacheSize) + "/" + std::to_string(maxCacheSize) +
-                            "\nHit Rate: " + std::to_string((int)hitRate) + "%";
-    getDisplayString().setTagArg("t", 0, statusText.c_str());
+    IF_VISUALIZE {
+        std::string statusText = "HTTP Server\nCache: " + std::to_string(responseCache.size()) + "/" + std::to_string(maxCacheSize) +
+                                "\nHit Rate: " + std::to_string((int)hitRate) + "%";
+        getDisplayString().setTagArg("t", 0, statusText.c_str());
+    }
     
-    double delay = delayDistribution(rng);
+    // Single-flight: the page is already being generated for another miss, share that result
+    if (coalesceMisses && generation != inFlight.end()) {
+        PendingResponse *waiter = new PendingResponse("DelayedProcessing", SERVER_DELAYED_PROCESSING);
+        waiter->setRequest(request);
+        generation->second.waiters.push_back(waiter);
+        
+        missesCoalesced++;
+        emit(missCoalescedSignal, 1);
+        LOG_EV << "Miss for page '" << pageName << "' joins the running generation (" 
+           << generation->second.waiters.size() << " waiting)" << endl;
+        
+        delete request;
+        return;
+    }
+    
+    RandomStream requestRng = serviceTimeRng.substream(request->getRequestKey());
+    double delay = sampleGenerationCost(request->getResourceId(), requestRng);
     emit(processingTimeSignal, delay);
     
     // Store the request information and gate for delayed processing
-    cMessage *delayedMsg = new cMessage("DelayedProcessing");
-    delayedMsg->addPar("originalRequestId") = request->getRequestId();
-    delayedMsg->addPar("clientId") = request->getClientId();
-    delayedMsg->addPar("resourceId") = request->getResourceId();
-    delayedMsg->addPar("fromPage") = request->getFromPage();
-    delayedMsg->addPar("arrivalGate") = request->getArrivalGate()->getIndex();
+    PendingResponse *delayedMsg = new PendingResponse("DelayedProcessing", SERVER_DELAYED_PROCESSING);
+    delayedMsg->setRequest(request);
+    
+    // The first miss leads the generation; later misses for the page wait for it
+    if (generation == inFlight.end()) {
+        InFlightGeneration& leader = inFlight[request->getResourceId()];
+        leader.cost = delay;
+        leader.job = delayedMsg;
+    }
     
-    // Schedule the delayed processing
-    scheduleAt(simTime() + delay, delayedMsg);
+    // Hand the request to a worker (or the queue)
+    submitJob(delayedMsg, delay);
     
-    EV << "Scheduled processing with delay " << delay << "s" << endl;
+    LOG_EV << "Submitted processing with delay " << delay << "s" << endl;
     
     // Delete the original request as we've extracted all needed information
     delete request;
 }
 
-void HttpServer::processDelayedRequest(cMessage *delayedMsg)
+void HttpServer::processDelayedRequest(PendingResponse *delayedMsg)
+{
+    finishJob(delayedMsg);
+    
+    // Collect the misses that waited for this generation
+    int resourceId = delayedMsg->getResourceId();
+    std::vector<PendingResponse*> waiters;
+    auto it = inFlight.find(resourceId);
+    if (it != inFlight.end() && it->second.job == delayedMsg) {
+        waiters.swap(it->second.waiters);
+        inFlight.erase(it);
+    }
+    
+    // The generated page fills the cache once, however many requests shared it
+    PageInfo* pageInfo = getPageInfo(resourceId);
+    if (demandFill && pageInfo && pageInfo->cacheable && !responseCache.contains(resourceId)) {
+        CacheEntry cacheEntry(resourceId, pageInfo->content, cacheTTL);
+        cacheEntry.setTimestamp(simTime());
+        cacheEntry.setProvenance(CacheEntry::DEMAND_FILLED);
+        cacheEntry.setGenerationCost(delayedMsg->getServiceTime());
+        addToCacheWithManagement(cacheEntry);
+    }
+    
+    sendGeneratedResponse(delayedMsg);
+    for (PendingResponse *waiter : waiters) {
+        sendGeneratedResponse(waiter);
+    }
+}
+
+void HttpServer::sendGeneratedResponse(PendingResponse *delayedMsg)
 {
     // Extract request information from the delayed message
-    int requestId = delayedMsg->par("originalRequestId");
-    int clientId = delayedMsg->par("clientId");
-    int resourceId = delayedMsg->par("resourceId");
-    int fromPage = delayedMsg->par("fromPage");
-    int arrivalGate = delayedMsg->par("arrivalGate");
+    int requestId = delayedMsg->getRequestId();
+    int clientId = delayedMsg->getClientId();
+    int resourceId = delayedMsg->getResourceId();
+    int fromPage = delayedMsg->getFromPage();
+    int arrivalGate = delayedMsg->getArrivalGateIndex();
     
-    EV << "Processing delayed request ID " << requestId 
+    LOG_EV << "Processing delayed request ID " << requestId 
        << " for resource " << resourceId << endl;
     
     // Get the page information
@@ -418,44 +1114,41 @@ void HttpServer::processDelayedRequest(cMessage *delayedMsg)
         // Create HTTP response
         HttpResponse *response = new HttpResponse("HttpResponse");
         response->setRequestId(requestId);
+        response->setClientId(clientId);
         response->setResourceId(resourceId);
         response->setContent(pageInfo->content);
+        if (delayedMsg->getResponseSize() > 0) {
+            response->setContentSize(delayedMsg->getResponseSize());  // Replayed trace: the logged size
+        }
         response->setTimestamp(simTime());
-        response->setTtl(pageInfo->ttl);
-        response->setCacheable(true);
+        setCacheHeaders(response, pageInfo);
         
         // Send response back to the client through the same gate
-        send(response, "out", arrivalGate);
-
+        transmitResponse(response, arrivalGate);
+        
         // Reset color to gold after processing
-        getDisplayString().setTagArg("i", 1, "gold");
-
+        IF_VISUALIZE getDisplayString().setTagArg("i", 1, "gold");
+        
         responsesGenerated++;
         emit(responseGeneratedSignal, responsesGenerated);
         
         // Calculate and emit response time
-        auto startTimeIt = requestStartTimes.find(requestId);
-        if (startTimeIt != requestStartTimes.end()) {
-            double responseTime = SIMTIME_DBL(simTime() - startTimeIt->second);
-            emit(responseTimeSignal, responseTime);
-            requestStartTimes.erase(startTimeIt);
+        simtime_t startTime;
+        if (requestStartTimes.take(delayedMsg->getRequestKey(), startTime)) {
+            double responseTime = SIMTIME_DBL(simTime() - startTime);
+            recordResponseTime(resourceId, responseTime, missResponseTimeSignal);
             emit(requestCompleteSignal, 1);
             
-            EV << "Response time for request " << requestId << ": " << responseTime << "s" << endl;
+            LOG_EV << "Response time for request " << requestId << ": " << responseTime << "s" << endl;
         }
         
-        // Pattern learning: Update pattern table if we have previous page information
-        std::string currentPageName = getPageName(resourceId);
-        std::string fromPageName = getPageName(fromPage);
-        
-        if (fromPage >= 0) {  // Valid fromPage
-            updatePatternTable(clientId, fromPageName, currentPageName);
-        }
+        // Pattern learning: session history and, with a valid fromPage, the global table
+        updatePatternTable(clientId, fromPage, resourceId);
         
-        // Trigger predictive pre-caching after serving the response
-        predictivePreCache(currentPageName);
+        // Trigger predictive pre-caching (and push to this client) after serving the response
+        predictivePreCache(clientId, resourceId, arrivalGate);
         
-        EV << "Sent HttpResponse for page '" << pageInfo->pageName 
+        LOG_EV << "Sent HttpResponse for page '" << pageInfo->pageName 
            << "' (size: " << pageInfo->contentSize << " bytes) "
            << "to client " << clientId 
            << " through gate " << arrivalGate << endl;
@@ -465,38 +1158,66 @@ void HttpServer::processDelayedRequest(cMessage *delayedMsg)
         // Send error response
         HttpResponse *errorResponse = new HttpResponse("HttpResponse");
         errorResponse->setRequestId(requestId);
+        errorResponse->setClientId(clientId);
         errorResponse->setResourceId(resourceId);
         errorResponse->setContent("ERROR 404: Page not found");
+        errorResponse->setStatusCode(404);
         errorResponse->setTimestamp(simTime());
         errorResponse->setTtl(300);  // Short TTL for error pages
         errorResponse->setCacheable(false);
         
-        send(errorResponse, "out", arrivalGate);
+        transmitResponse(errorResponse, arrivalGate);
         responsesGenerated++;
         emit(responseGeneratedSignal, responsesGenerated);
         
         // Calculate response time for error responses too
-        auto startTimeIt = requestStartTimes.find(requestId);
-        if (startTimeIt != requestStartTimes.end()) {
-            double responseTime = SIMTIME_DBL(simTime() - startTimeIt->second);
+        simtime_t startTime;
+        if (requestStartTimes.take(delayedMsg->getRequestKey(), startTime)) {
+            double responseTime = SIMTIME_DBL(simTime() - startTime);
             emit(responseTimeSignal, responseTime);
-            requestStartTimes.erase(startTimeIt);
             emit(requestCompleteSignal, 1);
             
-            EV << "Response time for error request " << requestId << ": " << responseTime << "s" << endl;
+            LOG_EV << "Response time for error request " << requestId << ": " << responseTime << "s" << endl;
         }
     }
     
     delete delayedMsg;
 }
 
-HttpServer::PageInfo* HttpServer::getPageInfo(int pageId)
+PageInfo* HttpServer::getPageInfo(int pageId)
 {
-    auto it = webPages.find(pageId);
-    if (it != webPages.end()) {
-        return &(it->second);
+    return webPages.find(pageId);
+}
+
+void HttpServer::setCacheHeaders(HttpResponse *response, const PageInfo *pageInfo)
+{
+    // Cache-Control max-age plus the validators a client needs to revalidate later
+    response->setCacheable(!pageInfo || pageInfo->cacheable);
+    if (!pageInfo) {
+        return;
+    }
+    response->setTtl(responseMaxAge >= 0 ? responseMaxAge : pageInfo->ttl);
+    response->setValidators(pageInfo->etag, pageInfo->lastModified);
+}
+
+double HttpServer::sampleGenerationCost(int resourceId, RandomStream& rng)
+{
+    // Catalog pages may state their own cost, otherwise the default 100-200ms
+    PageInfo* pageInfo = getPageInfo(resourceId);
+    if (pageInfo && pageInfo->cost.isSet()) {
+        return std::max(0.0, pageInfo->cost.sample(rng));
+    }
+    return delayDistribution(rng);
+}
+
+void HttpServer::recordResponseTime(int resourceId, double responseTime, simsignal_t pathSignal)
+{
+    // All responses, the hit or miss path, and the page's own histogram
+    emit(responseTimeSignal, responseTime);
+    emit(pathSignal, responseTime);
+    if (pageLatencyPercentiles) {
+        pageLatency[resourceId].record(responseTime);
     }
-    return nullptr;
 }
 
 std::string HttpServer::generatePageContent(const std::string& pageName)
@@ -559,32 +1280,62 @@ void HttpServer::finish()
                 requestsReceived > 0 ? (double)responsesGenerated / requestsReceived : 0);
     recordScalar("webPagesCount", webPages.size());
     
-    // Record page-specific statistics
-    for (const auto& page : webPages) {
-        std::string statName = "page_" + page.second.pageName + "_size";
-        recordScalar(statName.c_str(), page.second.contentSize);
+    // Record output link usage (link utilisation over time is the linkUtilization_* statistics)
+    int64_t bytesSent = 0;
+    size_t maxTxQueue = 0;
+    for (TransmissionQueue& queue : txQueues) {
+        bytesSent += queue.getBytesSent();
+        maxTxQueue = std::max(maxTxQueue, queue.getMaxLength());
+        queue.clear();
+    }
+    recordScalar("bytesSent", bytesSent);
+    recordScalar("maxTxQueueLength", maxTxQueue);
+    
+    // Record page-specific statistics (large catalogs only as totals)
+    recordScalar("catalogBytes", webPages.getTotalBytes());
+    if (webPages.size() <= 32) {
+        for (const PageInfo& page : webPages.getPages()) {
+            if (page.pageId >= 0) {
+                std::string statName = "page_" + page.pageName + "_size";
+                recordScalar(statName.c_str(), page.contentSize);
+            }
+        }
+    }
+    
+    // Record per-page latency percentiles (pages that were requested)
+    for (const auto& entry : pageLatency) {
+        static const double percentiles[] = {50, 90, 99, 99.9};
+        static const char *suffixes[] = {"_p50", "_p90", "_p99", "_p99.9"};
+        std::string prefix = "page_" + getPageName(entry.first) + "_responseTime";
+        for (int i = 0; i < 4; i++) {
+            recordScalar((prefix + suffixes[i]).c_str(), entry.second.getValueAtPercentile(percentiles[i]), "s");
+        }
     }
     
     // Print pattern learning statistics
     printPatternStatistics();
     
-    // Clean up cache management
-    if (cacheCleanupTimer && cacheCleanupTimer->isScheduled()) {
-        cancelAndDelete(cacheCleanupTimer);
-    }
-    
-    // Cancel all pending cache expiry messages
-    for (auto& pair : cacheExpiryMessages) {
-        if (pair.second && pair.second->isScheduled()) {
-            cancelAndDelete(pair.second);
+    // Save the learned patterns for the next run's warm start
+    if (!patternSnapshotFile.empty() && ownsPatternSnapshot && savePatternSnapshot) {
+        if (patternTable->saveSnapshot(patternSnapshotFile)) {
+            EV << "Pattern table saved to " << patternSnapshotFile << endl;
+        } else {
+            EV << "ERROR: Could not write pattern snapshot " << patternSnapshotFile << endl;
         }
     }
-    cacheExpiryMessages.clear();
+    
+    // Clean up cache management
+    cancelAndDelete(cacheExpiryTimer);
+    cacheExpiryTimer = nullptr;
+    cancelAndDelete(controllerTimer);
+    controllerTimer = nullptr;
     
     // Record cache statistics
+    int finalCacheSize = responseCache.size();
     recordScalar("maxCacheSize", maxCacheSize);
-    recordScalar("finalCacheSize", currentCacheSize);
-    recordScalar("cacheUtilization", currentCacheSize > 0 ? (double)currentCacheSize / maxCacheSize : 0.0);
+    recordScalar("finalCacheSize", finalCacheSize);
+    recordScalar("cacheUtilization", finalCacheSize > 0 ? (double)finalCacheSize / maxCacheSize : 0.0);
+    recordScalar("finalCacheBytes", responseCache.getBytes());
     
     // Record comprehensive metrics
     int totalRequests = totalCacheHits + totalCacheMisses;
@@ -598,9 +1349,51 @@ void HttpServer::finish()
     recordScalar("averageTimeSaved", totalCacheHits > 0 ? totalTimeSaved / totalCacheHits : 0.0);
     
     // Record configuration parameters used
-    recordScalar("configPredictionThreshold", predictionThreshold);
-    recordScalar("configCacheTTL", cacheTTL);
+    recordScalar("configPredictionThreshold", par("predictionThreshold").doubleValue());
+    recordScalar("configCacheTTL", par("cacheTTL").intValue());
     recordScalar("configMaxCacheSize", maxCacheSize);
+    recordScalar("configMaxCacheBytes", maxCacheBytes);
+    recordScalar("configNumWorkers", missWorkers.getNumWorkers());
+    
+    // Record prefetch outcomes (entries still cached at the end are not counted) and work
+    long prefetchOutcomes = prefetchUseful + prefetchExpiredUnused + prefetchEvictedUnused;
+    recordScalar("prefetchIssued", prefetchIssued);
+    recordScalar("prefetchUseful", prefetchUseful);
+    recordScalar("prefetchWasted", prefetchExpiredUnused);
+    recordScalar("prefetchEvictedUnused", prefetchEvictedUnused);
+    recordScalar("prefetchPrecision", prefetchOutcomes > 0 ? (double)prefetchUseful / prefetchOutcomes : 0.0);
+    recordScalar("prefetchBudgetDenied", prefetchBudgetDenied);
+    recordScalar("prefetchWork", prefetchWork);
+    recordScalar("prefetchLate", prefetchLate);
+    recordScalar("latePrefetchTimeSaved", latePrefetchTimeSaved);
+    recordScalar("prefetchDropped", prefetchDropped);
+    if (pushCount > 0) {
+        recordScalar("pushSent", pushSent);
+        recordScalar("pushBytes", pushBytes);
+        recordScalar("pushBudgetDenied", pushBudgetDenied);
+        recordScalar("pushDuplicates", pushDuplicates);
+    }
+    recordScalar("missesCoalesced", missesCoalesced);
+    recordScalar("notModifiedSent", notModifiedSent);
+    
+    // Record compressed tier activity
+    if (cacheCodec.isEnabled()) {
+        recordScalar("compressedInserts", compressedInserts);
+        recordScalar("decompressions", decompressions);
+        recordScalar("compressionPromotions", compressionPromotions);
+        recordScalar("totalDecompressionTime", totalDecompressionTime);
+    }
+    
+    // Record the controller's final choice
+    if (adaptiveThreshold) {
+        recordScalar("finalPredictionThreshold", predictionThreshold);
+        recordScalar("finalCacheTTL", cacheTTL);
+        recordScalar("thresholdAdjustments", thresholdController.getAdjustments());
+    }
+    
+    // Record worker pool statistics
+    recordScalar("requestsDropped", requestsDropped);
+    recordScalar("dropRate", requestsReceived > 0 ? (double)requestsDropped / requestsReceived : 0.0);
     
     // Emit final cache hit rate
     if (totalRequests > 0) {
@@ -613,337 +1406,424 @@ void HttpServer::finish()
     EV << "Cache misses: " << totalCacheMisses << endl;
     EV << "Total time saved: " << totalTimeSaved << "s" << endl;
     EV << "Average time saved per cache hit: " << (totalCacheHits > 0 ? totalTimeSaved / totalCacheHits : 0.0) << "s" << endl;
+    EV << "Prefetches: " << prefetchIssued << " issued (" << prefetchWork << "s of work), " 
+       << prefetchUseful << " useful, " << prefetchExpiredUnused << " expired unused, " 
+       << prefetchEvictedUnused << " evicted unused, " << prefetchLate << " late (" << latePrefetchTimeSaved << "s saved), " 
+       << prefetchBudgetDenied << " denied by budget, " << prefetchDropped << " dropped by a full queue" << endl;
 }
 
 // Pattern learning method implementations
-void HttpServer::updatePatternTable(int clientId, const std::string& fromPage, const std::string& toPage)
+void HttpServer::updatePatternTable(int clientId, int fromPage, int toPage)
 {
-    if (fromPage.empty() || toPage.empty() || fromPage == toPage) {
-        return;  // Skip invalid transitions
+    // Context for higher-order learning: the client's pages up to and including fromPage
+    std::vector<int> context;
+    if (patternTable->getContextOrder() > 1) {
+        sessionPredictor.getRecentPages(clientId, patternTable->getContextOrder(), context);
+    }
+    if (context.empty() || context.back() != fromPage) {
+        context.assign(1, fromPage);
     }
     
-    // Create transition key
-    std::pair<std::string, std::string> transition(fromPage, toPage);
+    // The client's session history sees every visit, the global table only real transitions
+    sessionPredictor.recordVisit(clientId, toPage);
     
-    // Update pattern table
-    patternTable[transition]++;
+    if (fromPage < 0 || toPage < 0 || fromPage == toPage) {
+        return;  // Skip invalid transitions
+    }
+    
+    // Update pattern table (first-order transition plus its longer contexts)
+    patternTable->recordContextTransition(context, toPage);
+    double count = patternTable->getTransitionCount(fromPage, toPage);
     
     // Visual feedback for pattern learning
-    getDisplayString().setTagArg("i", 1, "yellow");
-    std::string bubbleText = "Pattern \n" + fromPage + " → " + toPage;
-    bubble(bubbleText.c_str());
+    IF_VISUALIZE {
+        getDisplayString().setTagArg("i", 1, "yellow");
+        std::string bubbleText = "Pattern \n" + getPageName(fromPage) + " → " + getPageName(toPage);
+        bubble(bubbleText.c_str());
+    }
     
     // Emit pattern learning signal
-    emit(patternLearnedSignal, patternTable[transition]);
-    
-    // Update client's last page for next transition
-    clientLastPage[clientId] = toPage;
+    emit(patternLearnedSignal, count);  // Decayed count when patternHalfLife is set
     
-    EV << "Pattern learning: Client " << clientId << " transition " 
-       << fromPage << " -> " << toPage 
-       << " (count: " << patternTable[transition] << ")" << endl;
+    LOG_EV << "Pattern learning: Client " << clientId << " transition " 
+       << getPageName(fromPage) << " -> " << getPageName(toPage) 
+       << " (count: " << count << ")" << endl;
 }
 
-double HttpServer::calculateTransitionProbability(const std::string& fromPage, const std::string& toPage)
+double HttpServer::calculateTransitionProbability(int fromPage, int toPage)
 {
-    if (fromPage.empty() || toPage.empty()) {
+    if (fromPage < 0 || toPage < 0) {
         return 0.0;
     }
     
-    // Find the specific transition
-    std::pair<std::string, std::string> targetTransition(fromPage, toPage);
-    auto targetIt = patternTable.find(targetTransition);
-    
-    if (targetIt == patternTable.end()) {
-        return 0.0;  // No occurrences of this transition
-    }
-    
-    // Calculate total transitions from the fromPage
-    int totalFromPage = 0;
-    for (const auto& entry : patternTable) {
-        if (entry.first.first == fromPage) {
-            totalFromPage += entry.second;
-        }
-    }
-    
-    if (totalFromPage == 0) {
-        return 0.0;
-    }
+    // Per-source totals are kept by the pattern table, so this is O(out-degree)
+    double probability = patternTable->getTransitionProbability(fromPage, toPage);
     
-    // Calculate probability
-    double probability = static_cast<double>(targetIt->second) / totalFromPage;
-    
-    EV << "Transition probability " << fromPage << " -> " << toPage 
-       << ": " << probability << " (" << targetIt->second 
-       << "/" << totalFromPage << ")" << endl;
+    LOG_EV << "Transition probability " << getPageName(fromPage) << " -> " << getPageName(toPage) 
+       << ": " << probability << " (" << patternTable->getTransitionCount(fromPage, toPage) 
+       << "/" << patternTable->getTotalTransitionsFrom(fromPage) << ")" << endl;
     
     return probability;
 }
 
-std::string HttpServer::getPageName(int pageId)
+const std::string& HttpServer::getPageName(int pageId)
 {
-    // Convert page ID to page name
-    switch (pageId) {
-        case HOME: return "home";
-        case LOGIN: return "login";
-        case DASHBOARD: return "dashboard";
-        case PROFILE: return "profile";
-        case SETTINGS: return "settings";
-        case LOGOUT: return "logout";
-        default: return "unknown";
-    }
+    return webPages.getName(pageId);
 }
 
 void HttpServer::printPatternStatistics()
 {
     EV << "=== Pattern Learning Statistics ===" << endl;
-    EV << "Total unique transitions learned: " << patternTable.size() << endl;
+    EV << "Total unique transitions learned: " << patternTable->getPatternCount() << endl;
     
-    if (patternTable.empty()) {
+    if (patternTable->getPatternCount() == 0) {
         EV << "No patterns learned yet." << endl;
         return;
     }
     
-    // Sort patterns by frequency
-    std::vector<std::pair<int, std::pair<std::string, std::string>>> sortedPatterns;
-    for (const auto& entry : patternTable) {
-        sortedPatterns.push_back({entry.second, entry.first});
-    }
-    
-    std::sort(sortedPatterns.rbegin(), sortedPatterns.rend());
+    // Patterns sorted by frequency (top 10)
+    std::vector<PatternTable::PageTransition> topPatterns = patternTable->getTopTransitions(10);
     
     EV << "Top navigation patterns:" << endl;
-    int count = 0;
-    for (const auto& pattern : sortedPatterns) {
-        if (count >= 10) break;  // Show top 10
-        
-        int frequency = pattern.first;
-        const std::string& fromPage = pattern.second.first;
-        const std::string& toPage = pattern.second.second;
+    for (const auto& pattern : topPatterns) {
+        int fromPage = pattern.first;
+        int toPage = pattern.second;
+        double frequency = patternTable->getTransitionCount(fromPage, toPage);
         double probability = calculateTransitionProbability(fromPage, toPage);
         
-        EV << "  " << fromPage << " -> " << toPage 
+        EV << "  " << getPageName(fromPage) << " -> " << getPageName(toPage) 
            << ": " << frequency << " times (probability: " 
            << std::fixed << std::setprecision(3) << probability << ")" << endl;
-        count++;
     }
     
     // Record pattern statistics
-    recordScalar("totalPatterns", patternTable.size());
-    recordScalar("activeClients", clientLastPage.size());
+    recordScalar("totalPatterns", patternTable->getPatternCount());
+    recordScalar("activeClients", sessionPredictor.getSessionCount());
+    if (patternTable->getContextOrder() > 1) {
+        recordScalar("contextTrieNodes", patternTable->getContextTrie().getNodeCount());
+        recordScalar("contextTrieDropped", patternTable->getContextTrie().getDroppedContexts());
+    }
+    if (patternTable->getHalfLife() > 0 || par("maxPatterns").intValue() > 0) {
+        recordScalar("prunedPatterns", patternTable->getPrunedPatterns());
+    }
     
     // Record most frequent transition
-    if (!sortedPatterns.empty()) {
-        recordScalar("maxTransitionCount", sortedPatterns[0].first);
+    if (!topPatterns.empty()) {
+        recordScalar("maxTransitionCount", 
+                     patternTable->getTransitionCount(topPatterns[0].first, topPatterns[0].second));
     }
 }
 
-bool HttpServer::checkResponseCache(const std::string& page, std::string& cachedResponse)
+bool HttpServer::checkResponseCache(int resourceId, PageContent& cachedResponse, double& savedCost, double& decompressTime)
 {
-    auto cacheIt = responseCache.find(page);
-    if (cacheIt != responseCache.end()) {
-        if (!cacheIt->second.isExpired()) {
-            // Cache hit
-            cachedResponse = cacheIt->second.getContent();
-            cacheIt->second.updateAccess();
-            return true;
-        } else {
-            // Cache expired, remove entry
-            EV << "Cache entry for page '" << page << "' expired during lookup" << endl;
-            
-            // Cancel expiry message if it exists
-            auto expiryIt = cacheExpiryMessages.find(page);
-            if (expiryIt != cacheExpiryMessages.end()) {
-                cancelAndDelete(expiryIt->second);
-                cacheExpiryMessages.erase(expiryIt);
-            }
-            
-            responseCache.erase(cacheIt);
-            currentCacheSize--;
-            emit(cacheExpiredSignal, 1);
-            emit(cacheSizeSignal, currentCacheSize);
+    bool expired = false;
+    CacheEntry* entry = responseCache.lookup(resourceId, expired);
+    if (expired) {
+        // The expiry timer had not fired yet
+        LOG_EV << "Cache entry for page '" << getPageName(resourceId) << "' expired during lookup" << endl;
+        emit(cacheExpiredSignal, 1);
+        emit(cacheSizeSignal, responseCache.size());
+        emit(cacheBytesSignal, (long)responseCache.getBytes());
+    }
+    if (!entry) {
+        return false;
+    }
+    
+    // Cache hit (hands out the shared body)
+    cachedResponse = entry->getContentHandle();
+    savedCost = entry->getGenerationCost();
+    if (entry->recordHit() == 1 && entry->isPrefetched()) {
+        // First hit makes the prefetch useful
+        prefetchUseful++;
+        emit(prefetchUsefulSignal, 1);
+        thresholdController.recordUseful();
+    }
+    
+    if (entry->isCompressed()) {
+        decompressTime = cacheCodec.decompressionTime(entry->getContentSize());
+        decompressions++;
+        
+        // Hot entry: keep it uncompressed from now on if the byte budget allows
+        if (compressHotHits > 0 && entry->getHits() >= compressHotHits &&
+            responseCache.hasRoomFor(resourceId, entry->getUncompressedMemorySize())) {
+            entry->setStoredSize(0);
+            responseCache.updateSize(resourceId);
+            compressionPromotions++;
+            emit(cacheBytesSignal, (long)responseCache.getBytes());
         }
     }
-    return false;
+    return true;
 }
 
-void HttpServer::predictivePreCache(const std::string& currentPage)
+void HttpServer::predictivePreCache(int clientId, int currentPage, int clientGate)
 {
-    // Find all transitions from current page
-    for (const auto& pattern : patternTable) {
-        const std::string& fromPage = pattern.first.first;
-        const std::string& toPage = pattern.first.second;
+    // The client's own history decides once it is long enough, otherwise the global table
+    PatternTable::Predictions& predictions = predictionBuffer;
+    bool fromSession = (predictorMode == PREDICT_SESSION) && sessionPredictor.predict(clientId, currentPage, predictions);
+    if (predictorMode == PREDICT_PPM) {
+        // Condition on the client's last pages (its history already ends with currentPage)
+        std::vector<int> context;
+        sessionPredictor.getRecentPages(clientId, patternTable->getContextOrder(), context);
+        if (context.empty() || context.back() != currentPage) {
+            context.assign(1, currentPage);
+        }
+        int orderUsed = 0;
+        predictions = patternTable->getPredictionsWithConfidence(context, &orderUsed);
+        emit(predictionOrderSignal, orderUsed);
+    } else if (!fromSession) {
+        // Top candidates straight from the sorted edges, O(K)
+        patternTable->getTopPredictions(currentPage, patternTable->getMaxPredictions(), predictions);
+    }
+    if (predictorMode == PREDICT_SESSION) {
+        emit(sessionPredictionSignal, fromSession);
+    }
+    
+    // Candidates are sorted by probability
+    for (const auto& prediction : predictions) {
+        double probability = prediction.second;
+        if (probability <= predictionThreshold) {
+            break;  // Remaining candidates are even less likely
+        }
+        
+        int toPageId = prediction.first;
+        const std::string& toPage = getPageName(toPageId);
+        if (!ownsPage(toPageId)) {
+            continue;  // Requests for it are routed to another shard, which prefetches it itself
+        }
         
-        if (fromPage == currentPage) {
-            double probability = calculateTransitionProbability(fromPage, toPage);
+        // Check if already cached and not expired, or already being generated
+        CacheEntry* cached = responseCache.find(toPageId);
+        bool needsPreCache = (inFlight.find(toPageId) == inFlight.end());
+        
+        if (needsPreCache && cached) {
+            if (!cached->isExpired()) {
+                needsPreCache = false; // Already cached and fresh
+            } else {
+                responseCache.erase(toPageId, CacheRemovalListener::EXPIRED); // Remove expired entry
+                emit(cacheExpiredSignal, 1);
+            }
+        }
+        
+        PageInfo* pageInfo = getPageInfo(toPageId);
+        if (needsPreCache && pageInfo && pageInfo->cacheable) {
+            // Generating the page costs as much server time as a miss; the budget caps that work
+            double generationCost = sampleGenerationCost(toPageId, prefetchRng);
+            if (!prefetchBudget.tryConsume(generationCost, simTime())) {
+                LOG_EV << "Prefetch budget exhausted, skipping pre-cache of page '" << toPage << "'" << endl;
+                prefetchBudgetDenied++;
+                emit(prefetchBudgetDeniedSignal, 1);
+                break;  // Less likely candidates would not be cheaper on average
+            }
             
-            if (probability > predictionThreshold) {
-                // Check if already cached and not expired
-                auto cacheIt = responseCache.find(toPage);
-                bool needsPreCache = true;
-                
-                if (cacheIt != responseCache.end()) {
-                    if (!cacheIt->second.isExpired()) {
-                        needsPreCache = false; // Already cached and fresh
-                    } else {
-                        responseCache.erase(cacheIt); // Remove expired entry
-                    }
-                }
-                
-                if (needsPreCache) {
-                    // Pre-generate response for likely next page
-                    std::string responseContent = generatePageContent(toPage);
-                    
-                    // Create cache entry with configurable TTL
-                    // We'll use -1 as resourceId since we're indexing by page name
-                    CacheEntry cacheEntry(-1, responseContent, cacheTTL);
-                    cacheEntry.setTimestamp(simTime());
-                    
-                    // Use cache management system to add entry
-                    if (addToCacheWithManagement(toPage, cacheEntry)) {
-                        EV << "Pre-cached response for page '" << toPage 
-                           << "' (probability: " << std::fixed << std::setprecision(3) 
-                           << probability << ", TTL: " << cacheTTL << "s)" << endl;
-                        
-                        // Visual feedback for predictive caching
-                        getDisplayString().setTagArg("i", 1, "cyan");
-                        std::string bubbleText = "Pre-cache \n" + toPage + " " + std::to_string((int)(probability*100)) + "%";
-                        bubble(bubbleText.c_str());
-                        
-                        emit(cachePreGeneratedSignal, 1);
-                        
-                        // Schedule expiry for this cache entry
-                        scheduleCacheExpiry(toPage, (double)cacheTTL);
-                    } else {
-                        EV << "Failed to cache page '" << toPage << "' - cache full" << endl;
-                    }
-                }
+            // Generate the response in the background on a low-priority worker;
+            // completePrefetch() caches it once the generation time has passed
+            InFlightGeneration& generation = inFlight[toPageId];
+            generation.prefetch = true;
+            generation.probability = probability;
+            generation.cost = generationCost;
+            
+            PendingResponse *prefetchJob = new PendingResponse("Prefetch", SERVER_PREFETCH_COMPLETE);
+            prefetchJob->setResourceId(toPageId);
+            generation.job = prefetchJob;
+            if (!submitJob(prefetchJob, generationCost)) {
+                break;  // Queue full: dropPrefetch() undid the in-flight record and the budget
             }
+            
+            // Counted as issued work only once a worker runs or queues it
+            prefetchIssued++;
+            prefetchWork += generationCost;
+            emit(prefetchCostSignal, generationCost);
+            LOG_EV << "Prefetch of page '" << toPage << "' started (probability: " 
+               << std::fixed << std::setprecision(3) << probability << ")" << endl;
         }
     }
+    
+    if (pushCount > 0 && clientGate >= 0) {
+        pushPredictedPages(clientId, currentPage, clientGate, predictions);
+    }
 }
 
-void HttpServer::scheduleCacheExpiry(const std::string& pageName, double ttlSeconds)
+void HttpServer::pushPredictedPages(int clientId, int currentPage, int clientGate, const PatternTable::Predictions& predictions)
 {
-    // Cancel existing expiry message if any
-    auto expiryIt = cacheExpiryMessages.find(pageName);
-    if (expiryIt != cacheExpiryMessages.end()) {
-        cancelAndDelete(expiryIt->second);
-        cacheExpiryMessages.erase(expiryIt);
+    // Only pages that are cached and fresh are pushed: pushing costs link bytes, not generation time
+    int pushed = 0;
+    for (const auto& prediction : predictions) {
+        if (pushed >= pushCount || prediction.second <= pushThreshold) {
+            break;  // Candidates are sorted by probability
+        }
+        
+        int pageId = prediction.first;
+        uint64_t key = makeRequestKey(clientId, pageId);
+        simtime_t *until = pushedUntil.find(key);
+        CacheEntry* cached = responseCache.find(pageId);
+        PageInfo* pageInfo = getPageInfo(pageId);
+        if (pageId == currentPage || (until && *until > simTime()) || !cached || cached->isExpired() || !pageInfo || !ownsPage(pageId)) {
+            continue;
+        }
+        
+        // Per-client byte budget; a page that does not fit ends this round
+        int64_t bytes = responseFormat.messageBytes(cached->getContentSize());
+        auto budget = pushBudgets.find(clientId);
+        if (budget == pushBudgets.end()) {
+            budget = pushBudgets.emplace(clientId, TokenBucket()).first;
+            budget->second.configure(pushBudgetRate, pushBudgetBurst, simTime());
+        }
+        if (!budget->second.tryConsume(bytes, simTime())) {
+            pushBudgetDenied++;
+            emit(pushBudgetDeniedSignal, 1);
+            break;
+        }
+        
+        HttpResponse *push = new HttpResponse("HttpPush");
+        push->setClientId(clientId);
+        push->setResourceId(pageId);
+        push->setContent(cached->getContentHandle());
+        push->setTimestamp(simTime());
+        push->setPushed(true);
+        setCacheHeaders(push, pageInfo);
+        pushedUntil[key] = simTime() + push->getTtl();
+        transmitResponse(push, clientGate, true);
+        
+        pushed++;
+        pushSent++;
+        pushBytes += bytes;
+        emit(pushSentSignal, 1);
+        LOG_EV << "Pushed page '" << pageInfo->pageName << "' to client " << clientId 
+           << " (probability: " << std::fixed << std::setprecision(3) << prediction.second << ")" << endl;
     }
-    
-    // Schedule new expiry message
-    std::string msgName = "CacheExpiry_" + pageName;
-    cMessage* expiryMsg = new cMessage(msgName.c_str());
-    cacheExpiryMessages[pageName] = expiryMsg;
-    scheduleAt(simTime() + ttlSeconds, expiryMsg);
-    
-    EV << "Scheduled cache expiry for page '" << pageName << "' in " << ttlSeconds << "s" << endl;
 }
 
-void HttpServer::handleCacheExpiry(const std::string& pageName)
+bool HttpServer::ownsPage(int pageId) const
 {
-    auto cacheIt = responseCache.find(pageName);
-    if (cacheIt != responseCache.end()) {
-        EV << "Cache entry for page '" << pageName << "' expired and removed" << endl;
-        responseCache.erase(cacheIt);
-        currentCacheSize--;
-        emit(cacheExpiredSignal, 1);
-        emit(cacheSizeSignal, currentCacheSize);
-    }
-    
-    // Remove expiry message reference
-    auto expiryIt = cacheExpiryMessages.find(pageName);
-    if (expiryIt != cacheExpiryMessages.end()) {
-        cacheExpiryMessages.erase(expiryIt);
-    }
+    return shardIndex < 0 || shardRing.lookup(pageId) == shardIndex;
 }
 
-void HttpServer::cleanupExpiredCache()
+void HttpServer::scheduleCacheExpiry()
 {
-    int expiredCount = 0;
-    auto cacheIt = responseCache.begin();
+    // One self-message tracks the earliest pending expiry of the whole cache
+    if (!responseCache.hasPendingExpiry()) {
+        cancelEvent(cacheExpiryTimer);
+        return;
+    }
     
-    while (cacheIt != responseCache.end()) {
-        if (cacheIt->second.isExpired()) {
-            EV << "Cleaning up expired cache entry for page '" << cacheIt->first << "'" << endl;
-            
-            // Cancel and remove expiry message if it exists
-            auto expiryIt = cacheExpiryMessages.find(cacheIt->first);
-            if (expiryIt != cacheExpiryMessages.end()) {
-                cancelAndDelete(expiryIt->second);
-                cacheExpiryMessages.erase(expiryIt);
-            }
-            
-            cacheIt = responseCache.erase(cacheIt);
-            currentCacheSize--;
-            expiredCount++;
-        } else {
-            ++cacheIt;
+    simtime_t nextExpiry = responseCache.getNextExpiry();
+    if (cacheExpiryTimer->isScheduled()) {
+        if (cacheExpiryTimer->getArrivalTime() == nextExpiry) {
+            return;
         }
+        cancelEvent(cacheExpiryTimer);
     }
+    scheduleAt(std::max(nextExpiry, simTime()), cacheExpiryTimer);
+}
+
+void HttpServer::handleCacheExpiry()
+{
+    int expiredCount = responseCache.expire(simTime());
     
     if (expiredCount > 0) {
-        EV << "Cleaned up " << expiredCount << " expired cache entries" << endl;
+        LOG_EV << "Expired " << expiredCount << " cache entries" << endl;
         emit(cacheExpiredSignal, expiredCount);
-        emit(cacheSizeSignal, currentCacheSize);
+        emit(cacheSizeSignal, responseCache.size());
+        emit(cacheBytesSignal, (long)responseCache.getBytes());
+    }
+    
+    scheduleCacheExpiry();
+}
+
+void HttpServer::compressIfCold(CacheEntry& entry)
+{
+    // New entries are cold unless they already collected compressHotHits hits (late prefetch waiters)
+    bool hot = compressHotHits > 0 && entry.getHits() >= compressHotHits;
+    if (cacheCodec.isEnabled() && !hot && entry.getContentSize() >= compressMinSize) {
+        entry.setStoredSize(cacheCodec.compressedSize(entry.getContentSize()));
     }
 }
 
-void HttpServer::evictLeastRecentlyUsed()
+bool HttpServer::addToCacheWithManagement(const CacheEntry& newEntry, double admissionWeight)
 {
-    if (responseCache.empty()) return;
+    CacheEntry entry = newEntry;  // Shares the body
+    compressIfCold(entry);
     
-    // Find the least recently used cache entry
-    auto lruIt = responseCache.begin();
-    simtime_t oldestAccess = lruIt->second.getLastAccess();
+    int resourceId = entry.getResourceId();
     
-    for (auto it = responseCache.begin(); it != responseCache.end(); ++it) {
-        if (it->second.getLastAccess() < oldestAccess) {
-            oldestAccess = it->second.getLastAccess();
-            lruIt = it;
+    // Expiry, admission and eviction (reported through onCacheRemoval) happen inside the cache
+    int expiredCount = 0;
+    ResponseCache::AddResult result = responseCache.add(entry, simTime(), admissionWeight, expiredCount);
+    if (expiredCount > 0) {
+        LOG_EV << "Expired " << expiredCount << " cache entries" << endl;
+        emit(cacheExpiredSignal, expiredCount);
+    }
+    if (result != ResponseCache::ADDED) {
+        if (result == ResponseCache::TOO_LARGE) {
+            LOG_EV << "Page '" << getPageName(resourceId) << "' (" << entry.getMemorySize() 
+               << " B) exceeds the whole cache byte budget, not cached" << endl;
         }
+        emit(cacheAdmissionRejectedSignal, 1);
+        emit(cacheSizeSignal, responseCache.size());
+        emit(cacheBytesSignal, (long)responseCache.getBytes());
+        scheduleCacheExpiry();
+        return false;
     }
     
-    EV << "Evicting LRU cache entry for page '" << lruIt->first << "'" << endl;
-    
-    // Cancel and remove expiry message if it exists
-    auto expiryIt = cacheExpiryMessages.find(lruIt->first);
-    if (expiryIt != cacheExpiryMessages.end()) {
-        cancelAndDelete(expiryIt->second);
-        cacheExpiryMessages.erase(expiryIt);
+    if (entry.isCompressed()) {
+        compressedInserts++;
     }
+    emit(cacheSizeSignal, responseCache.size());
+    emit(cacheBytesSignal, (long)responseCache.getBytes());
+    scheduleCacheExpiry();
     
-    responseCache.erase(lruIt);
-    currentCacheSize--;
-    emit(cacheEvictedSignal, 1);
-    emit(cacheSizeSignal, currentCacheSize);
+    LOG_EV << "Added page '" << getPageName(resourceId) << "' to cache (size: " 
+       << responseCache.size() << "/" << maxCacheSize << ", " << responseCache.getBytes() << " B)" << endl;
+    return true;
 }
 
-void HttpServer::updateCacheSize()
+void HttpServer::onCacheRemoval(const CacheEntry& entry, CacheRemovalListener::Cause cause)
 {
-    currentCacheSize = responseCache.size();
-    emit(cacheSizeSignal, currentCacheSize);
+    // Victims are only ever evicted to make room in addToCacheWithManagement()
+    if (cause == CacheRemovalListener::EVICTED) {
+        LOG_EV << "Evicting " << responseCache.getPolicyName() << " victim: cache entry for page '" 
+           << getPageName(entry.getResourceId()) << "'" << endl;
+        emit(cacheEvictedSignal, 1);
+    }
+    
+    // A prefetched entry leaving the cache before its first hit was wasted work
+    if (!entry.isPrefetched() || entry.getHits() > 0) {
+        return;
+    }
+    
+    bool expired = (cause == CacheRemovalListener::EXPIRED);
+    if (expired) {
+        prefetchExpiredUnused++;
+        emit(prefetchWastedSignal, 1);
+    } else {
+        prefetchEvictedUnused++;
+        emit(prefetchEvictedUnusedSignal, 1);
+    }
+    thresholdController.recordWasted(expired);
 }
 
-bool HttpServer::addToCacheWithManagement(const std::string& pageName, const CacheEntry& entry)
+void HttpServer::handleControllerTick()
 {
-    // Check if cache is full
-    if (currentCacheSize >= maxCacheSize) {
-        // First try to clean up expired entries
-        cleanupExpiredCache();
-        
-        // If still full, evict LRU entry
-        if (currentCacheSize >= maxCacheSize) {
-            evictLeastRecentlyUsed();
-        }
+    double cachePressure = maxCacheSize > 0 ? (double)responseCache.size() / maxCacheSize : 1.0;
+    if (maxCacheBytes > 0) {
+        cachePressure = std::max(cachePressure, (double)responseCache.getBytes() / maxCacheBytes);
+    }
+    if (thresholdController.update(cachePressure, intervalRequests)) {
+        LOG_EV << "Adaptive threshold: " << predictionThreshold << " -> " << thresholdController.getThreshold() 
+           << " (interval precision " << thresholdController.getIntervalPrecision() 
+           << ", cache pressure " << cachePressure << ")" << endl;
     }
+    intervalRequests = 0;
     
-    // Add to cache
-    responseCache[pageName] = entry;
-    currentCacheSize++;
-    emit(cacheSizeSignal, currentCacheSize);
+    predictionThreshold = thresholdController.getThreshold();
+    emit(predictionThresholdSignal, predictionThreshold);
+    if (thresholdController.isTtlAdaptive()) {
+        cacheTTL = thresholdController.getTtl();  // New entries only
+        emit(adaptiveCacheTTLSignal, cacheTTL);
+    }
+    if (thresholdController.getIntervalPrecision() >= 0) {
+        emit(prefetchPrecisionSignal, thresholdController.getIntervalPrecision());
+    }
     
-    EV << "Added page '" << pageName << "' to cache (size: " << currentCacheSize << "/" << maxCacheSize << ")" << endl;
-    return true;
+    scheduleAt(simTime() + controllerInterval, controllerTimer);
 }
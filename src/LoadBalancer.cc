@@ -0,0 +1,238 @@
+#include <omnetpp.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "HttpMessage.h"
+#include "FlatHashMap.h"
+#include "ConsistentHashRing.h"
+#include "TransmissionQueue.h"
+#include "Visuals.h"
+
+using namespace omnetpp;
+
+/**
+ * Load balancer in front of several HttpServer shards
+ * Routes each request round-robin, to the shard with the fewest outstanding
+ * requests, or by consistent hashing on resourceId (each page is cached on
+ * one shard), and sends responses back to the client they belong to.
+ */
+class LoadBalancer : public cSimpleModule
+{
+public:
+    enum Routing {
+        ROUND_ROBIN = 0,
+        LEAST_OUTSTANDING = 1,
+        CONSISTENT_HASH = 2
+    };
+
+private:
+    // Route of an in-flight request
+    struct Route {
+        int clientGate;
+        int server;
+    };
+    
+    // Routing state
+    Routing routing;
+    int numServers;
+    int nextServer;  // Round-robin position, also the tie-break start for least-outstanding
+    ConsistentHashRing ring;
+    std::vector<int> outstanding;  // server -> requests sent but not yet answered
+    FlatHashMap<Route> routes;  // makeRequestKey(clientId, requestId) -> route
+    FlatHashMap<int> clientGates;  // clientId -> clientIn/clientOut index, routes server pushes
+    std::vector<TransmissionQueue> clientQueues;  // One per clientOut[] gate
+    std::vector<TransmissionQueue> serverQueues;  // One per serverOut[] gate
+    bool verbose;  // Per-request log lines (configurable)
+    
+    // Statistics
+    long requestsRouted;
+    std::vector<long> requestsPerServer;
+    simsignal_t requestRoutedSignal;
+    simsignal_t outstandingSignal;
+
+protected:
+    virtual void initialize() override;
+    virtual void handleMessage(cMessage *msg) override;
+    virtual void finish() override;
+    
+    // Helper methods
+    virtual int selectServer(const HttpRequest *request);
+    virtual void routeRequest(HttpRequest *request);
+    virtual void routeResponse(HttpResponse *response);
+};
+
+Define_Module(LoadBalancer);
+
+void LoadBalancer::initialize()
+{
+    numServers = gateSize("serverOut");
+    if (numServers == 0) {
+        throw cRuntimeError("LoadBalancer has no servers connected");
+    }
+    
+    std::string routingName = par("routing").stdstringValue();
+    if (routingName == "roundrobin") {
+        routing = ROUND_ROBIN;
+    } else if (routingName == "leastoutstanding") {
+        routing = LEAST_OUTSTANDING;
+    } else if (routingName == "consistenthash") {
+        routing = CONSISTENT_HASH;
+    } else {
+        throw cRuntimeError("Unknown routing '%s' (expected roundrobin, leastoutstanding or consistenthash)", routingName.c_str());
+    }
+    
+    ring.setVirtualNodes(par("virtualNodes").intValue());
+    ring.build(numServers);
+    verbose = par("verbose").boolValue();
+    
+    nextServer = 0;
+    outstanding.assign(numServers, 0);
+    requestsPerServer.assign(numServers, 0);
+    requestsRouted = 0;
+    
+    requestRoutedSignal = registerSignal("requestRouted");
+    outstandingSignal = registerSignal("outstanding");
+    
+    // Forwarded packets keep their byte length and wait for busy links
+    simsignal_t txQueueingDelaySignal = registerSignal("txQueueingDelay");
+    serverQueues.resize(numServers);
+    for (int i = 0; i < numServers; i++) {
+        serverQueues[i].init(this, gate("serverOut", i), txQueueingDelaySignal);
+    }
+    clientQueues.resize(gateSize("clientOut"));
+    for (int i = 0; i < (int)clientQueues.size(); i++) {
+        clientQueues[i].init(this, gate("clientOut", i), txQueueingDelaySignal);
+    }
+    
+    EV << "LoadBalancer initialized: " << numServers << " servers, routing=" << routingName 
+       << ", virtualNodes=" << ring.getVirtualNodes() << endl;
+}
+
+void LoadBalancer::handleMessage(cMessage *msg)
+{
+    if (TransmissionQueue::isTimer(msg)) {
+        TransmissionQueue::handleTimer(msg);
+        return;
+    }
+    
+    if (msg->arrivedOn("clientIn")) {
+        HttpRequest *request = dynamic_cast<HttpRequest*>(msg);
+        if (request) {
+            routeRequest(request);
+            return;
+        }
+    } else if (msg->arrivedOn("serverIn")) {
+        HttpResponse *response = dynamic_cast<HttpResponse*>(msg);
+        if (response) {
+            routeResponse(response);
+            return;
+        }
+    }
+    
+    EV << "ERROR: Unexpected message " << msg->getClassName() << " on gate " 
+       << (msg->getArrivalGate() ? msg->getArrivalGate()->getFullName() : "none") << endl;
+    delete msg;
+}
+
+int LoadBalancer::selectServer(const HttpRequest *request)
+{
+    switch (routing) {
+        case CONSISTENT_HASH:
+            return ring.lookup(request->getResourceId());
+        
+        case LEAST_OUTSTANDING: {
+            // Scan from the round-robin position so ties spread across servers
+            int best = nextServer;
+            for (int i = 1; i < numServers; i++) {
+                int server = (nextServer + i) % numServers;
+                if (outstanding[server] < outstanding[best]) {
+                    best = server;
+                }
+            }
+            nextServer = (nextServer + 1) % numServers;
+            return best;
+        }
+        
+        case ROUND_ROBIN:
+        default: {
+            int server = nextServer;
+            nextServer = (nextServer + 1) % numServers;
+            return server;
+        }
+    }
+}
+
+void LoadBalancer::routeRequest(HttpRequest *request)
+{
+    int server = selectServer(request);
+    routes[request->getRequestKey()] = Route{request->getArrivalGate()->getIndex(), server};
+    clientGates[request->getClientId()] = request->getArrivalGate()->getIndex();
+    
+    outstanding[server]++;
+    requestsPerServer[server]++;
+    requestsRouted++;
+    emit(requestRoutedSignal, server);
+    emit(outstandingSignal, outstanding[server]);
+    
+    LOG_EV << "Routing request " << request->getRequestId() << " from client " << request->getClientId() 
+       << " (resource " << request->getResourceId() << ") to server " << server << endl;
+    
+    serverQueues[server].send(request);
+}
+
+void LoadBalancer::routeResponse(HttpResponse *response)
+{
+    // A server push answers no request: route it by client, behind normal responses
+    if (response->isPushed()) {
+        int *clientGate = clientGates.find(response->getClientId());
+        if (clientGate) {
+            clientQueues[*clientGate].send(response, true);
+        } else {
+            delete response;
+        }
+        return;
+    }
+    
+    // Earlier chunks of a chunked response leave the route in place
+    uint64_t key = makeRequestKey(response->getClientId(), response->getRequestId());
+    Route *found = routes.find(key);
+    if (!found) {
+        EV << "ERROR: Response for unknown request " << response->getRequestId() 
+           << " of client " << response->getClientId() << endl;
+        delete response;
+        return;
+    }
+    Route route = *found;
+    
+    if (response->isLastChunk()) {
+        routes.erase(key);
+        outstanding[route.server]--;
+    }
+    clientQueues[route.clientGate].send(response);
+}
+
+void LoadBalancer::finish()
+{
+    // Load imbalance: busiest server relative to the mean
+    long busiest = *std::max_element(requestsPerServer.begin(), requestsPerServer.end());
+    double mean = (double)requestsRouted / numServers;
+    
+    recordScalar("requestsRouted", requestsRouted);
+    recordScalar("numServers", numServers);
+    recordScalar("loadImbalance", mean > 0 ? busiest / mean : 0.0);
+    for (int server = 0; server < numServers; server++) {
+        std::string statName = "requestsServer_" + std::to_string(server);
+        recordScalar(statName.c_str(), requestsPerServer[server]);
+    }
+    
+    for (TransmissionQueue& queue : serverQueues) {
+        queue.clear();
+    }
+    for (TransmissionQueue& queue : clientQueues) {
+        queue.clear();
+    }
+    
+    EV << "LoadBalancer statistics:" << endl;
+    EV << "  Total requests routed: " << requestsRouted << endl;
+    EV << "  Load imbalance (max/mean): " << (mean > 0 ? busiest / mean : 0.0) << endl;
+}
@@ -0,0 +1,249 @@
+#include "PageCatalog.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+
+std::string trim(const std::string& text)
+{
+    size_t first = text.find_first_not_of(" \t\r");
+    if (first == std::string::npos) {
+        return "";
+    }
+    size_t last = text.find_last_not_of(" \t\r");
+    return text.substr(first, last - first + 1);
+}
+
+bool parseNumber(const std::string& text, double& value)
+{
+    char* end = nullptr;
+    value = std::strtod(text.c_str(), &end);
+    return !text.empty() && end && *end == '\0';
+}
+
+// Split on commas outside parentheses, so "uniform(1,2)" stays one field
+std::vector<std::string> splitFields(const std::string& line)
+{
+    std::vector<std::string> fields;
+    std::string field;
+    int depth = 0;
+    for (char c : line) {
+        if (c == ',' && depth == 0) {
+            fields.push_back(trim(field));
+            field.clear();
+            continue;
+        }
+        if (c == '(') {
+            depth++;
+        } else if (c == ')') {
+            depth--;
+        }
+        field += c;
+    }
+    fields.push_back(trim(field));
+    return fields;
+}
+
+}  // namespace
+
+// ValueDistribution
+ValueDistribution ValueDistribution::parse(const std::string& spec)
+{
+    ValueDistribution distribution;
+    std::string text = trim(spec);
+    if (text.empty() || text == "-") {
+        return distribution;
+    }
+    
+    double number;
+    if (parseNumber(text, number)) {
+        distribution.kind = FIXED;
+        distribution.a = number;
+        return distribution;
+    }
+    
+    size_t open = text.find('(');
+    if (open == std::string::npos || text.back() != ')') {
+        throw cRuntimeError("Bad value '%s' (expected a number or e.g. lognormal(8.5,1.2))", text.c_str());
+    }
+    std::string name = trim(text.substr(0, open));
+    std::vector<std::string> args = splitFields(text.substr(open + 1, text.size() - open - 2));
+    double first = 0, second = 0;
+    bool valid = !args.empty() && parseNumber(args[0], first) && (args.size() < 2 || parseNumber(args[1], second));
+    
+    int expectedArgs = 2;
+    if (name == "uniform") {
+        distribution.kind = UNIFORM;
+        valid = valid && second >= first;
+    } else if (name == "exponential") {
+        distribution.kind = EXPONENTIAL;
+        expectedArgs = 1;
+        valid = valid && first > 0;
+    } else if (name == "lognormal") {
+        distribution.kind = LOGNORMAL;
+        valid = valid && second >= 0;
+    } else if (name == "pareto") {
+        distribution.kind = PARETO;
+        valid = valid && first > 0 && second > 0;
+    } else {
+        throw cRuntimeError("Unknown distribution '%s' (expected uniform, exponential, lognormal or pareto)", name.c_str());
+    }
+    if (!valid || static_cast<int>(args.size()) != expectedArgs) {
+        throw cRuntimeError("Bad arguments in '%s'", text.c_str());
+    }
+    distribution.a = first;
+    distribution.b = second;
+    return distribution;
+}
+
+double ValueDistribution::sample(RandomStream& rng) const
+{
+    switch (kind) {
+        case FIXED:
+            return a;
+        case UNIFORM:
+            return std::uniform_real_distribution<double>(a, b)(rng);
+        case EXPONENTIAL:
+            return std::exponential_distribution<double>(1.0 / a)(rng);
+        case LOGNORMAL:
+            return std::lognormal_distribution<double>(a, b)(rng);
+        case PARETO: {
+            // Inverse CDF: min / U^(1/alpha)
+            double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+            return b / std::pow(1.0 - u, 1.0 / a);
+        }
+        case NONE:
+        default:
+            return 0.0;
+    }
+}
+
+// Modification methods
+void PageCatalog::add(const PageInfo& page)
+{
+    if (page.pageId < 0) {
+        return;
+    }
+    if (page.pageId >= static_cast<int>(pages.size())) {
+        pages.resize(page.pageId + 1);
+    }
+    
+    PageInfo& slot = pages[page.pageId];
+    if (slot.pageId >= 0) {
+        totalBytes -= slot.contentSize;  // Redefined page
+    } else {
+        pageCount++;
+    }
+    slot = page;
+    totalBytes += page.contentSize;
+}
+
+void PageCatalog::load(const std::string& fileName, uint64_t seed)
+{
+    RandomStream catalogStream(seed);
+    std::ifstream in(fileName.c_str());
+    if (!in) {
+        throw cRuntimeError("Cannot open page catalog '%s'", fileName.c_str());
+    }
+    
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(in, line)) {
+        lineNumber++;
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) {
+            line.erase(comment);
+        }
+        if (trim(line).empty()) {
+            continue;
+        }
+        
+        std::vector<std::string> fields = splitFields(line);
+        if (fields.size() < 3 || fields.size() > 6) {
+            throw cRuntimeError("%s:%d: expected id,name,size[,ttl[,cacheable[,cost]]]", fileName.c_str(), lineNumber);
+        }
+        
+        // id or first-last
+        int first, last;
+        char dash;
+        std::istringstream ids(fields[0]);
+        if (!(ids >> first)) {
+            throw cRuntimeError("%s:%d: bad page id '%s'", fileName.c_str(), lineNumber, fields[0].c_str());
+        }
+        last = first;
+        if (ids >> dash && !(dash == '-' && ids >> last)) {
+            throw cRuntimeError("%s:%d: bad page id range '%s'", fileName.c_str(), lineNumber, fields[0].c_str());
+        }
+        if (first < 0 || last < first) {
+            throw cRuntimeError("%s:%d: bad page id range '%s'", fileName.c_str(), lineNumber, fields[0].c_str());
+        }
+        
+        double ttl = 3600;
+        if (fields.size() > 3 && !fields[3].empty() && !parseNumber(fields[3], ttl)) {
+            throw cRuntimeError("%s:%d: bad ttl '%s'", fileName.c_str(), lineNumber, fields[3].c_str());
+        }
+        bool cacheable = true;
+        if (fields.size() > 4 && !fields[4].empty()) {
+            if (fields[4] != "true" && fields[4] != "false") {
+                throw cRuntimeError("%s:%d: cacheable must be true or false", fileName.c_str(), lineNumber);
+            }
+            cacheable = fields[4] == "true";
+        }
+        
+        try {
+            ValueDistribution size = ValueDistribution::parse(fields[2]);
+            ValueDistribution cost = fields.size() > 5 ? ValueDistribution::parse(fields[5]) : ValueDistribution();
+            if (!size.isSet()) {
+                throw cRuntimeError("missing size");
+            }
+            addRange(first, last, fields[1], size, static_cast<int>(ttl), cacheable, cost, catalogStream);
+        } catch (cRuntimeError& e) {
+            throw cRuntimeError("%s:%d: %s", fileName.c_str(), lineNumber, e.what());
+        }
+    }
+}
+
+void PageCatalog::clear()
+{
+    pages.clear();
+    pageCount = 0;
+    totalBytes = 0;
+}
+
+// Lookup methods
+const std::string& PageCatalog::getName(int pageId) const
+{
+    static const std::string unknown("unknown");
+    if (pageId < 0 || pageId >= static_cast<int>(pages.size()) || pages[pageId].pageId < 0) {
+        return unknown;
+    }
+    return pages[pageId].pageName;
+}
+
+// Private helper methods
+void PageCatalog::addRange(int first, int last, const std::string& name, const ValueDistribution& size,
+                           int ttl, bool cacheable, const ValueDistribution& cost, const RandomStream& catalogStream)
+{
+    if (last >= static_cast<int>(pages.size())) {
+        pages.resize(last + 1);
+    }
+    
+    for (int id = first; id <= last; id++) {
+        PageInfo page;
+        page.pageId = id;
+        page.pageName = (first == last) ? name : name + std::to_string(id);
+        RandomStream pageRng = catalogStream.substream(id);  // Independent of line order and other pages
+        page.contentSize = std::max(1, static_cast<int>(std::lround(size.sample(pageRng))));
+        page.ttl = ttl;
+        page.cacheable = cacheable;
+        page.cost = cost;
+        
+        // Validator from id and size; the body itself is created on first use
+        uint32_t tag = hashContentBytes(&id, sizeof(id));
+        page.etag = hashContentBytes(&page.contentSize, sizeof(page.contentSize), tag);
+        add(page);
+    }
+}
@@ -0,0 +1,119 @@
+#ifndef PAGECATALOG_H
+#define PAGECATALOG_H
+
+#include <omnetpp.h>
+#include <string>
+#include <vector>
+#include <random>
+#include <cstdint>
+#include "PageContent.h"
+#include "RandomStream.h"
+
+using namespace omnetpp;
+
+/**
+ * Random value specification used by the page catalog
+ * Written as a number (fixed) or as uniform(a,b), exponential(mean),
+ * lognormal(mu,sigma) (of the natural log) or pareto(alpha,min)
+ */
+struct ValueDistribution
+{
+    enum Kind { NONE, FIXED, UNIFORM, EXPONENTIAL, LOGNORMAL, PARETO };
+    
+    Kind kind;
+    double a;
+    double b;
+    
+    ValueDistribution() : kind(NONE), a(0), b(0) {}
+    
+    static ValueDistribution parse(const std::string& spec);  // "" or "-" gives NONE, throws cRuntimeError on bad specs
+    double sample(RandomStream& rng) const;
+    bool isSet() const { return kind != NONE; }
+};
+
+/**
+ * Web page information
+ * Built-in pages carry generated HTML; catalog pages carry a synthetic body
+ * of their size, created on first use
+ */
+struct PageInfo
+{
+    int pageId;  // -1 for an unused catalog slot
+    std::string pageName;
+    PageContent content;  // Built once, shared by cache entries and responses
+    int contentSize;
+    int ttl;  // Time to live in seconds
+    bool cacheable;  // false: never cached, responses are marked uncacheable
+    ValueDistribution cost;  // Generation time in seconds, NONE = the server's default
+    uint32_t etag;  // Validator for conditional requests
+    simtime_t lastModified;  // Pages are built once at start
+    
+    // Default constructor for unused slots
+    PageInfo() : pageId(-1), pageName(""), content(nullptr), contentSize(0), ttl(3600), cacheable(true),
+                 etag(0), lastModified(SIMTIME_ZERO) {}
+    
+    PageInfo(int id, const std::string& name, const PageContent& pageContent, int ttlSeconds = 3600)
+        : pageId(id), pageName(name), content(pageContent), ttl(ttlSeconds), cacheable(true), lastModified(SIMTIME_ZERO) {
+        contentSize = getPageContentSize(pageContent);
+        etag = makeContentTag(pageContent);
+    }
+};
+
+/**
+ * Page catalog: PageInfo densely indexed by resourceId
+ * Either filled by the server with built-in pages, or loaded from a catalog
+ * file. Lookups are a bounds check and an array access.
+ *
+ * File format: one page or page range per line, '#' starts a comment,
+ *   id,name,size,ttl,cacheable,cost
+ * id is a resourceId or an inclusive range first-last (name is then a prefix,
+ * page 17 of range "10-99,item" is "item17"); size is bytes or a
+ * ValueDistribution, sampled once per page; ttl is seconds; cacheable is
+ * true/false; cost is a ValueDistribution of seconds sampled per generation,
+ * empty for the server default. Trailing fields may be omitted.
+ * Sizes of page p are drawn from RandomStream(seed).substream(p), so every
+ * module loading a file with the same seed sees the same pages and ETags.
+ */
+class PageCatalog
+{
+private:
+    std::vector<PageInfo> pages;  // Index = resourceId
+    size_t pageCount;
+    int64_t totalBytes;
+
+public:
+    // Constructors
+    PageCatalog() : pageCount(0), totalBytes(0) {}
+    
+    // Modification methods
+    void add(const PageInfo& page);
+    void load(const std::string& fileName, uint64_t seed);  // Throws cRuntimeError on unreadable or malformed files
+    void clear();
+    
+    // Lookup methods
+    PageInfo* find(int pageId)
+    {
+        if (pageId < 0 || pageId >= static_cast<int>(pages.size()) || pages[pageId].pageId < 0) {
+            return nullptr;
+        }
+        PageInfo& page = pages[pageId];
+        if (!page.content) {
+            page.content = makeSyntheticContent(page.contentSize, page.etag);  // On first use
+        }
+        return &page;
+    }
+    const std::string& getName(int pageId) const;  // "unknown" outside the catalog
+    
+    // Getters
+    size_t size() const { return pageCount; }
+    bool empty() const { return pageCount == 0; }
+    int getIdLimit() const { return pages.size(); }  // All ids are below this
+    int64_t getTotalBytes() const { return totalBytes; }
+    const std::vector<PageInfo>& getPages() const { return pages; }  // Includes unused slots (pageId -1)
+
+private:
+    void addRange(int first, int last, const std::string& name, const ValueDistribution& size,
+                  int ttl, bool cacheable, const ValueDistribution& cost, const RandomStream& catalogStream);
+};
+
+#endif // PAGECATALOG_H
@@ -0,0 +1,67 @@
+#ifndef PAGECONTENT_H
+#define PAGECONTENT_H
+
+#include <memory>
+#include <string>
+#include <cstdint>
+
+/**
+ * Shared immutable page body
+ * A page body is built once and then shared by reference count between
+ * PageInfo, CacheEntry and HttpResponse; copying a handle (or dup()ing a
+ * response) never copies the bytes. Synthetic bodies only state their size:
+ * catalog pages of any size cost a few bytes each, and no text is built.
+ */
+struct PageBody
+{
+    std::string text;  // Empty for synthetic bodies
+    size_t size;  // Body bytes on the wire
+    uint32_t tag;  // Entity tag, never 0
+};
+
+typedef std::shared_ptr<const PageBody> PageContent;
+
+// FNV-1a over a byte range, never 0 so that 0 can mean "no tag"
+inline uint32_t hashContentBytes(const void* data, size_t length, uint32_t hash = 2166136261u)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash ? hash : 1;
+}
+
+// Wrap a freshly built body into a shared handle (the string is moved, not copied)
+inline PageContent makePageContent(std::string body)
+{
+    uint32_t tag = hashContentBytes(body.data(), body.length());
+    size_t size = body.length();
+    return std::make_shared<const PageBody>(PageBody{std::move(body), size, tag});
+}
+
+// Body of the given size without text; the tag identifies this version of the page
+inline PageContent makeSyntheticContent(size_t bytes, uint32_t tag)
+{
+    return std::make_shared<const PageBody>(PageBody{std::string(), bytes, tag ? tag : 1});
+}
+
+// Text of a handle, or an empty string for a null handle or a synthetic body
+inline const std::string& getPageContentText(const PageContent& content)
+{
+    static const std::string empty;
+    return content ? content->text : empty;
+}
+
+// Body size of a handle, 0 for a null handle
+inline size_t getPageContentSize(const PageContent& content)
+{
+    return content ? content->size : 0;
+}
+
+// Entity tag of a body (FNV-1a of its bytes, or the synthetic page's tag)
+inline uint32_t makeContentTag(const PageContent& content)
+{
+    return content ? content->tag : hashContentBytes(nullptr, 0);
+}
+
+#endif // PAGECONTENT_H
@@ -3,14 +3,32 @@
 #include <sstream>
 #include <iostream>
 #include <iomanip>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 // Constructors
 PatternTable::PatternTable(double threshold, int maxPred)
 {
     confidenceThreshold = threshold;
     maxPredictions = maxPred;
+    patternCount = 0;
     totalTransitions = 0;
     enableLearning = true;
+    contextOrder = 1;
+    decayRate = 0.0;
+    pruneWeight = 0.05;
+    maxPatterns = 0;
+    prunedPatterns = 0;
     
     // Initialize statistics
     totalUpdates = 0;
@@ -20,12 +38,18 @@ PatternTable::PatternTable(double threshold, int maxPred)
 
 PatternTable::PatternTable(const PatternTable& other)
 {
-    transitions = other.transitions;
-    predictions = other.predictions;
+    sources = other.sources;
+    patternCount = other.patternCount;
+    contextTrie = other.contextTrie;
+    contextOrder = other.contextOrder;
     totalTransitions = other.totalTransitions;
     confidenceThreshold = other.confidenceThreshold;
     maxPredictions = other.maxPredictions;
     enableLearning = other.enableLearning;
+    decayRate = other.decayRate;
+    pruneWeight = other.pruneWeight;
+    maxPatterns = other.maxPatterns;
+    prunedPatterns = other.prunedPatterns;
     totalUpdates = other.totalUpdates;
     predictionRequests = other.predictionRequests;
     successfulPredictions = other.successfulPredictions;
@@ -42,12 +66,18 @@ PatternTable& PatternTable::operator=(const PatternTable& other)
 {
     if (this == &other) return *this;
     
-    transitions = other.transitions;
-    predictions = other.predictions;
+    sources = other.sources;
+    patternCount = other.patternCount;
+    contextTrie = other.contextTrie;
+    contextOrder = other.contextOrder;
     totalTransitions = other.totalTransitions;
     confidenceThreshold = other.confidenceThreshold;
     maxPredictions = other.maxPredictions;
     enableLearning = other.enableLearning;
+    decayRate = other.decayRate;
+    pruneWeight = other.pruneWeight;
+    maxPatterns = other.maxPatterns;
+    prunedPatterns = other.prunedPatterns;
     totalUpdates = other.totalUpdates;
     predictionRequests = other.predictionRequests;
     successfulPredictions = other.successfulPredictions;
@@ -62,13 +92,19 @@ void PatternTable::recordTransition(int fromPage, int toPage)
         return;
     }
     
-    PageTransition transition(fromPage, toPage);
-    transitions[transition]++;
+    SourceEntry& source = getOrCreateSource(fromPage);
+    double weight = incrementWeight(source);
+    addToEdge(source, getOrCreateEdge(source, toPage), weight);
+    source.total += weight;
     totalTransitions++;
     totalUpdates++;
     
-    // Invalidate cached predictions for this fromPage
-    predictions.erase(fromPage);
+    if (decayRate > 0) {
+        pruneTail(source, pruneWeight);
+    }
+    if (maxPatterns > 0 && patternCount > maxPatterns) {
+        enforceBudget();
+    }
 }
 
 void PatternTable::recordSequence(const std::vector<int>& pageSequence)
@@ -77,8 +113,26 @@ void PatternTable::recordSequence(const std::vector<int>& pageSequence)
         return;
     }
     
+    // Every page is recorded with its preceding context, so page order is kept up to contextOrder
+    std::vector<int> context;
     for (size_t i = 0; i < pageSequence.size() - 1; i++) {
-        recordTransition(pageSequence[i], pageSequence[i + 1]);
+        context.push_back(pageSequence[i]);
+        if (static_cast<int>(context.size()) > contextOrder) {
+            context.erase(context.begin());
+        }
+        recordContextTransition(context, pageSequence[i + 1]);
+    }
+}
+
+void PatternTable::recordContextTransition(const std::vector<int>& context, int toPage)
+{
+    if (!enableLearning || context.empty()) {
+        return;
+    }
+    
+    recordTransition(context.back(), toPage);
+    if (contextOrder > 1 && isValidPage(toPage)) {
+        contextTrie.record(context, toPage);
     }
 }
 
@@ -88,49 +142,44 @@ void PatternTable::updatePattern(int fromPage, int toPage, int count)
         return;
     }
     
-    PageTransition transition(fromPage, toPage);
-    transitions[transition] += count;
+    SourceEntry& source = getOrCreateSource(fromPage);
+    double weight = count * incrementWeight(source);
+    addToEdge(source, getOrCreateEdge(source, toPage), weight);
+    source.total += weight;
     totalTransitions += count;
     totalUpdates++;
     
-    // Invalidate cached predictions for this fromPage
-    predictions.erase(fromPage);
+    if (maxPatterns > 0 && patternCount > maxPatterns) {
+        enforceBudget();
+    }
 }
 
 // Pattern prediction methods
 std::vector<int> PatternTable::getPredictions(int currentPage) const
 {
-    const_cast<PatternTable*>(this)->predictionRequests++;
-    
-    if (!isValidPage(currentPage)) {
-        return std::vector<int>();
-    }
+    predictionRequests++;
+    std::vector<int> result;
     
-    // Check cache first
-    auto cacheIt = predictions.find(currentPage);
-    if (cacheIt != predictions.end()) {
-        return cacheIt->second;
+    // Edges are kept sorted, so the first ones below the threshold end the scan
+    const SourceEntry* source = findSource(currentPage);
+    if (!source || source->total == 0) {
+        return result;
     }
     
-    // Calculate predictions
-    std::vector<std::pair<int, double>> probabilities = calculateProbabilities(currentPage);
-    std::vector<int> result;
-    
-    for (const auto& prob : probabilities) {
-        if (prob.second >= confidenceThreshold && result.size() < static_cast<size_t>(maxPredictions)) {
-            result.push_back(prob.first);
+    for (const auto& edge : source->edges) {
+        if (static_cast<double>(edge.count) / source->total < confidenceThreshold || 
+            result.size() >= static_cast<size_t>(maxPredictions)) {
+            break;
         }
+        result.push_back(edge.toPage);
     }
     
-    // Cache the result
-    const_cast<PatternTable*>(this)->predictions[currentPage] = result;
-    
     return result;
 }
 
 std::vector<std::pair<int, double>> PatternTable::getPredictionsWithConfidence(int currentPage) const
 {
-    const_cast<PatternTable*>(this)->predictionRequests++;
+    predictionRequests++;
     
     if (!isValidPage(currentPage)) {
         return std::vector<std::pair<int, double>>();
@@ -139,6 +188,53 @@ std::vector<std::pair<int, double>> PatternTable::getPredictionsWithConfidence(i
     return calculateProbabilities(currentPage);
 }
 
+int PatternTable::getTopPredictions(int currentPage, int k, Predictions& result) const
+{
+    predictionRequests++;
+    result.clear();
+    
+    const SourceEntry* source = findSource(currentPage);
+    if (!source || source->total == 0) {
+        return 0;
+    }
+    
+    int limit = std::min<int>(k, source->edges.size());
+    for (int i = 0; i < limit; i++) {
+        const OutEdge& edge = source->edges[i];
+        result.push_back(std::make_pair(edge.toPage, static_cast<double>(edge.count) / source->total));
+    }
+    return limit;
+}
+
+std::vector<std::pair<int, double>> PatternTable::getPredictionsWithConfidence(const std::vector<int>& context, int* orderUsed) const
+{
+    if (orderUsed) {
+        *orderUsed = 0;
+    }
+    if (context.empty()) {
+        return std::vector<std::pair<int, double>>();
+    }
+    
+    // Longest well-supported context first, first-order transitions as the last resort
+    if (contextOrder > 1) {
+        ContextTrie::Predictions result;
+        int order = contextTrie.predict(context, result);
+        if (order > 1) {
+            predictionRequests++;
+            if (orderUsed) {
+                *orderUsed = order;
+            }
+            return result;
+        }
+    }
+    
+    std::vector<std::pair<int, double>> result = getPredictionsWithConfidence(context.back());
+    if (orderUsed && !result.empty()) {
+        *orderUsed = 1;
+    }
+    return result;
+}
+
 int PatternTable::getMostLikelyNextPage(int currentPage) const
 {
     auto probabilities = calculateProbabilities(currentPage);
@@ -156,50 +252,43 @@ double PatternTable::getTransitionProbability(int fromPage, int toPage) const
         return 0.0;
     }
     
-    PageTransition transition(fromPage, toPage);
-    auto it = transitions.find(transition);
-    
-    if (it == transitions.end()) {
+    const SourceEntry* source = findSource(fromPage);
+    if (!source || source->total == 0) {
         return 0.0;
     }
     
-    int totalFromPage = getTotalTransitionsFrom(fromPage);
-    if (totalFromPage == 0) {
-        return 0.0;
-    }
-    
-    return static_cast<double>(it->second) / totalFromPage;
+    // Both weights share the source's landmark, so no rescaling is needed
+    int index = findEdge(*source, toPage);
+    return index >= 0 ? source->edges[index].count / source->total : 0.0;
 }
 
 // Pattern analysis methods
-int PatternTable::getTransitionCount(int fromPage, int toPage) const
+double PatternTable::getTransitionCount(int fromPage, int toPage) const
 {
-    PageTransition transition(fromPage, toPage);
-    auto it = transitions.find(transition);
-    return (it != transitions.end()) ? it->second : 0;
+    const SourceEntry* source = findSource(fromPage);
+    int index = source ? findEdge(*source, toPage) : -1;
+    return index >= 0 ? source->edges[index].count * currentScale(*source) : 0;
 }
 
-int PatternTable::getTotalTransitionsFrom(int fromPage) const
+double PatternTable::getTotalTransitionsFrom(int fromPage) const
 {
-    int total = 0;
-    for (const auto& entry : transitions) {
-        if (entry.first.first == fromPage) {
-            total += entry.second;
-        }
-    }
-    return total;
+    const SourceEntry* source = findSource(fromPage);
+    return source ? source->total * currentScale(*source) : 0;
 }
 
 std::vector<PatternTable::PageTransition> PatternTable::getTopTransitions(int limit) const
 {
-    std::vector<std::pair<PageTransition, int>> sortedTransitions;
+    std::vector<std::pair<PageTransition, double>> sortedTransitions;
     
-    for (const auto& entry : transitions) {
-        sortedTransitions.push_back(entry);
+    for (size_t fromPage = 0; fromPage < sources.size(); fromPage++) {
+        double scale = currentScale(sources[fromPage]);
+        for (const auto& edge : sources[fromPage].edges) {
+            sortedTransitions.push_back(std::make_pair(PageTransition(fromPage, edge.toPage), edge.count * scale));
+        }
     }
     
     std::sort(sortedTransitions.begin(), sortedTransitions.end(),
-              [](const std::pair<PageTransition, int>& a, const std::pair<PageTransition, int>& b) {
+              [](const std::pair<PageTransition, double>& a, const std::pair<PageTransition, double>& b) {
                   return a.second > b.second;  // Sort by count descending
               });
     
@@ -218,15 +307,21 @@ std::vector<int> PatternTable::getReachablePages(int fromPage) const
 {
     std::vector<int> pages;
     
-    for (const auto& entry : transitions) {
-        if (entry.first.first == fromPage) {
-            pages.push_back(entry.first.second);
-        }
+    for (const auto& edge : getOutgoingEdges(fromPage)) {
+        pages.push_back(edge.toPage);
     }
     
     return pages;
 }
 
+const std::vector<PatternTable::OutEdge>& PatternTable::getOutgoingEdges(int fromPage) const
+{
+    static const std::vector<OutEdge> noEdges;
+    
+    const SourceEntry* source = findSource(fromPage);
+    return source ? source->edges : noEdges;
+}
+
 // Statistics methods
 double PatternTable::getPredictionAccuracy() const
 {
@@ -237,51 +332,313 @@ double PatternTable::getPredictionAccuracy() const
 // Maintenance methods
 void PatternTable::clear()
 {
-    transitions.clear();
-    predictions.clear();
+    sources.clear();
+    patternCount = 0;
+    contextTrie.clear();
     totalTransitions = 0;
     totalUpdates = 0;
     predictionRequests = 0;
     successfulPredictions = 0;
+    prunedPatterns = 0;
 }
 
-void PatternTable::clearPredictionsCache()
+void PatternTable::setContextModel(int maxOrder, int maxNodes, int minSupport)
 {
-    predictions.clear();
+    contextOrder = std::max(maxOrder, 1);
+    if (contextOrder > 1) {
+        contextTrie.configure(contextOrder, maxNodes, minSupport);
+    } else {
+        contextTrie.clear();
+    }
 }
 
-void PatternTable::compact(int minCount)
+void PatternTable::compact(double minCount)
 {
-    auto it = transitions.begin();
-    while (it != transitions.end()) {
-        if (it->second < minCount) {
-            totalTransitions -= it->second;
-            it = transitions.erase(it);
-        } else {
-            ++it;
-        }
+    // Edges are sorted, so the ones below minCount form a suffix of each source
+    for (auto& source : sources) {
+        pruneTail(source, minCount);
     }
-    clearPredictionsCache();
 }
 
 void PatternTable::decay(double factor)
 {
     if (factor <= 0.0 || factor >= 1.0) return;
     
-    for (auto& entry : transitions) {
-        entry.second = static_cast<int>(entry.second * factor);
-        if (entry.second == 0) entry.second = 1;  // Keep at least 1
+    totalTransitions = 0;
+    for (auto& source : sources) {
+        // Rescale decayed weights to the current time first, so flooring works on counts
+        double scale = currentScale(source);
+        source.landmark = simTime();
+        source.total = 0;
+        for (auto& edge : source.edges) {
+            edge.count = std::floor(edge.count * scale * factor);
+            if (edge.count < 1) edge.count = 1;  // Keep at least 1
+            source.total += edge.count;
+        }
+        totalTransitions += static_cast<int>(source.total);
+    }
+    // Scaling is monotonic, so the edges stay sorted
+}
+
+void PatternTable::setDecay(double halfLife, size_t patternBudget, double minWeight)
+{
+    decayRate = (halfLife > 0) ? std::log(2.0) / halfLife : 0.0;
+    maxPatterns = patternBudget;
+    pruneWeight = minWeight;
+}
+
+double PatternTable::getHalfLife() const
+{
+    return (decayRate > 0) ? std::log(2.0) / decayRate : 0.0;
+}
+
+// Persistence methods
+//
+// Snapshot layout (all integers little-endian):
+//   header  magic "HPTS", u16 version, u16 header size, u32 sources, u32 edges,
+//           u32 payload bytes, u32 FNV-1a checksum of the payload
+//   payload per non-empty source: varint page delta from the previous source,
+//           varint edge count, then varint toPage and varint count per edge,
+//           edges in the table's own (count-descending) order
+// Decayed counts are stored rounded to the snapshot time (at least 1) and
+// restart from the loading run's clock. The context trie is not included.
+namespace {
+
+const char SNAPSHOT_MAGIC[4] = {'H', 'P', 'T', 'S'};
+const uint16_t SNAPSHOT_VERSION = 1;
+const size_t SNAPSHOT_HEADER_SIZE = 24;
+
+void putU16(std::string& out, uint16_t value)
+{
+    out.push_back(static_cast<char>(value & 0xFF));
+    out.push_back(static_cast<char>(value >> 8));
+}
+
+void putU32(std::string& out, uint32_t value)
+{
+    for (int shift = 0; shift < 32; shift += 8) {
+        out.push_back(static_cast<char>((value >> shift) & 0xFF));
+    }
+}
+
+void putVarint(std::string& out, uint64_t value)
+{
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+uint32_t getU32(const unsigned char* p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+bool getVarint(const unsigned char*& p, const unsigned char* end, uint64_t& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        unsigned char byte = *p++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;  // Truncated or overlong
+}
+
+uint32_t fnv1a(const unsigned char* data, size_t length)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+}  // namespace
+
+std::string PatternTable::serialize() const
+{
+    std::string payload;
+    uint32_t sourceCount = 0;
+    uint32_t edgeCount = 0;
+    int previousPage = 0;
+    
+    for (size_t fromPage = 0; fromPage < sources.size(); fromPage++) {
+        const SourceEntry& source = sources[fromPage];
+        if (source.edges.empty()) {
+            continue;
+        }
+        
+        double scale = currentScale(source);
+        putVarint(payload, fromPage - previousPage);
+        putVarint(payload, source.edges.size());
+        for (const auto& edge : source.edges) {
+            // Rounding keeps the count-descending order
+            putVarint(payload, edge.toPage);
+            putVarint(payload, std::max<uint64_t>(1, std::llround(edge.count * scale)));
+        }
+        previousPage = fromPage;
+        sourceCount++;
+        edgeCount += source.edges.size();
     }
     
-    totalTransitions = static_cast<int>(totalTransitions * factor);
-    clearPredictionsCache();
+    std::string data(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    putU16(data, SNAPSHOT_VERSION);
+    putU16(data, SNAPSHOT_HEADER_SIZE);
+    putU32(data, sourceCount);
+    putU32(data, edgeCount);
+    putU32(data, payload.size());
+    putU32(data, fnv1a(reinterpret_cast<const unsigned char*>(payload.data()), payload.size()));
+    data += payload;
+    return data;
+}
+
+bool PatternTable::deserialize(const std::string& data)
+{
+    return deserialize(data.data(), data.size());
+}
+
+bool PatternTable::deserialize(const char* data, size_t length)
+{
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    if (length < SNAPSHOT_HEADER_SIZE || std::memcmp(p, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+        return false;
+    }
+    
+    uint16_t version = p[4] | (p[5] << 8);
+    uint16_t headerSize = p[6] | (p[7] << 8);
+    if (version != SNAPSHOT_VERSION || headerSize < SNAPSHOT_HEADER_SIZE || headerSize > length) {
+        return false;
+    }
+    uint32_t sourceCount = getU32(p + 8);
+    uint32_t edgeCount = getU32(p + 12);
+    uint32_t payloadSize = getU32(p + 16);
+    uint32_t checksum = getU32(p + 20);
+    
+    const unsigned char* payload = p + headerSize;
+    if (payloadSize != length - headerSize || fnv1a(payload, payloadSize) != checksum) {
+        return false;
+    }
+    
+    // Decode into a fresh edge set so a corrupt snapshot leaves the table untouched
+    std::vector<SourceEntry> loaded;
+    size_t loadedEdges = 0;
+    int loadedTransitions = 0;
+    const unsigned char* end = payload + payloadSize;
+    uint64_t fromPage = 0;
+    
+    for (uint32_t s = 0; s < sourceCount; s++) {
+        uint64_t delta, degree;
+        if (!getVarint(payload, end, delta) || !getVarint(payload, end, degree)) {
+            return false;
+        }
+        fromPage += delta;
+        if ((s > 0 && delta == 0) || fromPage > INT32_MAX || degree == 0 || degree > edgeCount - loadedEdges) {
+            return false;
+        }
+        
+        if (fromPage >= loaded.size()) {
+            loaded.resize(fromPage + 1);
+        }
+        SourceEntry& source = loaded[fromPage];
+        source.landmark = simTime();
+        source.edges.reserve(degree);
+        for (uint64_t e = 0; e < degree; e++) {
+            uint64_t toPage, count;
+            if (!getVarint(payload, end, toPage) || !getVarint(payload, end, count)) {
+                return false;
+            }
+            if (toPage > INT32_MAX || count == 0 || count > INT32_MAX) {
+                return false;
+            }
+            if (!source.edges.empty() && source.edges.back().count < count) {
+                return false;  // Edges must stay sorted
+            }
+            if (findEdge(source, toPage) >= 0) {
+                return false;  // Duplicate edge
+            }
+            appendEdge(source, toPage, count);
+            source.total += count;
+            loadedTransitions += count;
+        }
+        loadedEdges += degree;
+    }
+    if (loadedEdges != edgeCount || payload != end) {
+        return false;
+    }
+    
+    sources.swap(loaded);
+    patternCount = loadedEdges;
+    totalTransitions = loadedTransitions;
+    if (maxPatterns > 0 && patternCount > maxPatterns) {
+        enforceBudget();
+    }
+    return true;
+}
+
+bool PatternTable::saveSnapshot(const std::string& path) const
+{
+    std::string data = serialize();
+    std::string tempPath = path + ".tmp";
+    
+    {
+        std::ofstream out(tempPath.c_str(), std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+        out.write(data.data(), data.size());
+        if (!out) {
+            return false;
+        }
+    }
+    
+    // Concurrent runs sharing a snapshot never see a half-written file
+    std::remove(path.c_str());  // rename() does not replace existing files on Windows
+    return std::rename(tempPath.c_str(), path.c_str()) == 0;
+}
+
+bool PatternTable::loadSnapshot(const std::string& path)
+{
+#ifndef _WIN32
+    // Map the file and decode straight from the mapping, without copying it
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+    
+    void* mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+    
+    bool loaded = deserialize(static_cast<const char*>(mapping), info.st_size);
+    munmap(mapping, info.st_size);
+    return loaded;
+#else
+    std::ifstream in(path.c_str(), std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    return deserialize(data);
+#endif
 }
 
 // Debug and utility methods
 std::string PatternTable::toString() const
 {
     std::ostringstream oss;
-    oss << "PatternTable{patterns=" << transitions.size()
+    oss << "PatternTable{patterns=" << patternCount
         << ", totalTransitions=" << totalTransitions
         << ", accuracy=" << std::fixed << std::setprecision(3) << getPredictionAccuracy()
         << "}";
@@ -291,7 +648,7 @@ std::string PatternTable::toString() const
 void PatternTable::printStatistics() const
 {
     std::cout << "Pattern Table Statistics:" << std::endl;
-    std::cout << "  Total patterns: " << transitions.size() << std::endl;
+    std::cout << "  Total patterns: " << patternCount << std::endl;
     std::cout << "  Total transitions: " << totalTransitions << std::endl;
     std::cout << "  Total updates: " << totalUpdates << std::endl;
     std::cout << "  Prediction requests: " << predictionRequests << std::endl;
@@ -303,37 +660,197 @@ void PatternTable::printStatistics() const
 }
 
 // Private helper methods
-void PatternTable::updatePredictionsCache(int fromPage)
+bool PatternTable::isValidPage(int pageId) const
+{
+    return pageId >= 0;  // Simple validation - non-negative page IDs
+}
+
+const PatternTable::SourceEntry* PatternTable::findSource(int fromPage) const
 {
-    predictions[fromPage] = getPredictions(fromPage);
+    if (fromPage < 0 || static_cast<size_t>(fromPage) >= sources.size()) {
+        return nullptr;
+    }
+    return &sources[fromPage];
 }
 
-bool PatternTable::isValidPage(int pageId) const
+PatternTable::SourceEntry& PatternTable::getOrCreateSource(int fromPage)
 {
-    return pageId >= 0;  // Simple validation - non-negative page IDs
+    // Page IDs are dense resource IDs, so the index grows to the largest source seen
+    if (static_cast<size_t>(fromPage) >= sources.size()) {
+        sources.resize(fromPage + 1);
+    }
+    return sources[fromPage];
+}
+
+int PatternTable::findEdge(const SourceEntry& source, int toPage) const
+{
+    if (source.slotIndex) {
+        const int* slot = source.slotIndex->find(toPage);
+        return slot ? *slot : -1;
+    }
+    
+    // Short list, most frequent edges first
+    for (size_t i = 0; i < source.edges.size(); i++) {
+        if (source.edges[i].toPage == toPage) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int PatternTable::appendEdge(SourceEntry& source, int toPage, double count)
+{
+    int index = source.edges.size();
+    source.edges.push_back(OutEdge(toPage, count));
+    if (source.slotIndex) {
+        (*source.slotIndex)[toPage] = index;
+    } else if (source.edges.size() > INDEXED_DEGREE) {
+        source.slotIndex.reset(new FlatHashMap<int>(source.edges.size() * 2));
+        for (size_t i = 0; i < source.edges.size(); i++) {
+            (*source.slotIndex)[source.edges[i].toPage] = i;
+        }
+    }
+    return index;
+}
+
+int PatternTable::getOrCreateEdge(SourceEntry& source, int toPage)
+{
+    int index = findEdge(source, toPage);
+    if (index >= 0) {
+        return index;
+    }
+    
+    // New edges have count 0 and therefore belong at the end
+    patternCount++;
+    return appendEdge(source, toPage, 0);
+}
+
+void PatternTable::addToEdge(SourceEntry& source, int index, double count)
+{
+    source.edges[index].count += count;
+    
+    // Bubble up past edges with a smaller count; ties keep their older order
+    while (index > 0 && source.edges[index - 1].count < source.edges[index].count) {
+        std::swap(source.edges[index - 1], source.edges[index]);
+        if (source.slotIndex) {
+            (*source.slotIndex)[source.edges[index].toPage] = index;
+        }
+        index--;
+    }
+    if (source.slotIndex) {
+        (*source.slotIndex)[source.edges[index].toPage] = index;
+    }
+}
+
+double PatternTable::incrementWeight(SourceEntry& source)
+{
+    if (decayRate <= 0) {
+        return 1.0;
+    }
+    
+    simtime_t now = simTime();
+    if (source.edges.empty()) {
+        source.landmark = now;
+        source.total = 0;
+    }
+    
+    // Move the landmark before weights get too large for a double
+    double exponent = decayRate * SIMTIME_DBL(now - source.landmark);
+    if (exponent > 30.0) {
+        double scale = std::exp(-exponent);
+        for (auto& edge : source.edges) {
+            edge.count *= scale;
+        }
+        source.total *= scale;
+        source.landmark = now;
+        exponent = 0.0;
+    }
+    return std::exp(exponent);
+}
+
+double PatternTable::currentScale(const SourceEntry& source) const
+{
+    if (decayRate <= 0) {
+        return 1.0;
+    }
+    return std::exp(-decayRate * SIMTIME_DBL(simTime() - source.landmark));
+}
+
+void PatternTable::pruneTail(SourceEntry& source, double minWeight)
+{
+    // Compare in landmark units: current = weight * scale
+    double scale = currentScale(source);
+    while (!source.edges.empty() && source.edges.back().count * scale < minWeight) {
+        popEdge(source);
+    }
+}
+
+void PatternTable::popEdge(SourceEntry& source)
+{
+    source.total -= source.edges.back().count;
+    if (source.slotIndex) {
+        source.slotIndex->erase(source.edges.back().toPage);
+    }
+    source.edges.pop_back();
+    if (source.slotIndex && source.edges.size() <= INDEXED_DEGREE / 2) {
+        source.slotIndex.reset();  // Short again, scanning is enough
+    }
+    patternCount--;
+    prunedPatterns++;
+    if (source.edges.empty()) {
+        source.total = 0;
+    }
+}
+
+void PatternTable::enforceBudget()
+{
+    // Over budget: drop the weakest edges table-wide down to 90% of the budget
+    std::vector<double> weights;
+    weights.reserve(patternCount);
+    for (const auto& source : sources) {
+        double scale = currentScale(source);
+        for (const auto& edge : source.edges) {
+            weights.push_back(edge.count * scale);
+        }
+    }
+    
+    size_t keep = maxPatterns * 9 / 10;
+    if (weights.size() <= keep) {
+        return;
+    }
+    size_t drop = weights.size() - keep;
+    std::nth_element(weights.begin(), weights.begin() + (drop - 1), weights.end());
+    double cutoff = weights[drop - 1];  // Largest weight that goes
+    
+    // Everything below the cutoff, then as many ties at the cutoff as are still due
+    size_t ties = drop - std::count_if(weights.begin(), weights.begin() + (drop - 1),
+                                       [cutoff](double weight) { return weight < cutoff; });
+    for (auto& source : sources) {
+        pruneTail(source, cutoff);
+        double scale = currentScale(source);
+        while (ties > 0 && !source.edges.empty() && source.edges.back().count * scale == cutoff) {
+            popEdge(source);
+            ties--;
+        }
+    }
+    ASSERT(patternCount <= maxPatterns);
 }
 
 std::vector<std::pair<int, double>> PatternTable::calculateProbabilities(int fromPage) const
 {
     std::vector<std::pair<int, double>> probabilities;
-    int totalFromPage = getTotalTransitionsFrom(fromPage);
+    const SourceEntry* source = findSource(fromPage);
     
-    if (totalFromPage == 0) {
+    if (!source || source->total == 0) {
         return probabilities;
     }
     
-    for (const auto& entry : transitions) {
-        if (entry.first.first == fromPage) {
-            double probability = static_cast<double>(entry.second) / totalFromPage;
-            probabilities.push_back(std::make_pair(entry.first.second, probability));
-        }
+    // Edges are already sorted by count, descending
+    probabilities.reserve(source->edges.size());
+    for (const auto& edge : source->edges) {
+        double probability = static_cast<double>(edge.count) / source->total;
+        probabilities.push_back(std::make_pair(edge.toPage, probability));
     }
     
-    // Sort by probability descending
-    std::sort(probabilities.begin(), probabilities.end(),
-              [](const std::pair<int, double>& a, const std::pair<int, double>& b) {
-                  return a.second > b.second;
-              });
-    
     return probabilities;
 }
\ No newline at end of file
@@ -6,34 +6,93 @@
 #include <vector>
 #include <utility>
 #include <string>
+#include <memory>
+#include "ContextTrie.h"
+#include "FlatHashMap.h"
 
 using namespace omnetpp;
 
 /**
- * Pattern Table using STL map to track (fromPage, toPage) → count
- * Implements pattern-based prediction for HTTP request sequences
+ * Pattern Table tracking (fromPage, toPage) → count
+ * Transitions are stored in an adjacency index keyed by integer page ID:
+ * each source page keeps its outgoing edges sorted by count, updated in
+ * place (one element bubbles up per increment), so the top K predictions
+ * of a page are read in O(K) without sorting or allocating. An edge is found
+ * by scanning the (short, most frequent first) list; sources with many
+ * successors also keep a hash index, so memory grows with edges, not page IDs.
+ * Counts can decay exponentially with a half-life. Decay is lazy (forward
+ * decay): each source stores its edge weights relative to its own landmark
+ * time, so reading a count only rescales it and no sweep over the table is
+ * needed; weak edges are pruned as they fall behind, within maxPatterns.
+ * First-order edges can be saved to and warm-started from a binary snapshot.
+ * An optional ContextTrie adds variable-order (PPM-style) predictions
+ * conditioned on the last few pages.
  */
 class PatternTable
 {
 public:
     // Type definitions for cleaner code
     typedef std::pair<int, int> PageTransition;  // (fromPage, toPage)
-    typedef std::map<PageTransition, int> TransitionMap;
-    typedef std::map<int, std::vector<int>> PagePredictionMap;
-    
+    typedef std::vector<std::pair<int, double>> Predictions;  // (page, probability), most likely first
+    
+    // Outgoing edge of a source page
+    struct OutEdge {
+        int toPage;
+        double count;  // Weight relative to the source's landmark (plain count without decay)
+        
+        OutEdge(int to = -1, double c = 0) : toPage(to), count(c) {}
+    };
+    
+    // Outgoing edges of one source page with their summed count
+    struct SourceEntry {
+        double total;  // Sum of edge weights, same landmark
+        simtime_t landmark;  // Weights are e^(rate * (t - landmark)) per transition at t
+        std::vector<OutEdge> edges;  // Sorted by count, descending
+        std::unique_ptr<FlatHashMap<int>> slotIndex;  // toPage -> index in edges, only for long edge lists
+        
+        SourceEntry() : total(0), landmark(SIMTIME_ZERO) {}
+        SourceEntry(const SourceEntry& other)
+            : total(other.total), landmark(other.landmark), edges(other.edges),
+              slotIndex(other.slotIndex ? new FlatHashMap<int>(*other.slotIndex) : nullptr) {}
+        SourceEntry(SourceEntry&& other) = default;
+        SourceEntry& operator=(const SourceEntry& other)
+        {
+            if (this != &other) {
+                total = other.total;
+                landmark = other.landmark;
+                edges = other.edges;
+                slotIndex.reset(other.slotIndex ? new FlatHashMap<int>(*other.slotIndex) : nullptr);
+            }
+            return *this;
+        }
+        SourceEntry& operator=(SourceEntry&& other) = default;
+    };
+    
+    typedef std::vector<SourceEntry> AdjacencyIndex;  // fromPage -> outgoing edges
+
 private:
-    TransitionMap transitions;  // Map of (fromPage, toPage) → count
-    PagePredictionMap predictions;  // Cached predictions for each page
+    static const size_t INDEXED_DEGREE = 16;  // Above this many edges a source gets a slot index
+    
+    AdjacencyIndex sources;  // Indexed by fromPage
+    size_t patternCount;  // Number of distinct (fromPage, toPage) pairs
+    ContextTrie contextTrie;  // Higher-order contexts (only used if contextOrder > 1)
+    int contextOrder;  // 1: first-order transitions only
     int totalTransitions;
     double confidenceThreshold;  // Minimum confidence for predictions
     int maxPredictions;  // Maximum number of predictions per page
     bool enableLearning;  // Enable/disable pattern learning
     
+    // Time decay
+    double decayRate;  // ln 2 / half-life in 1/s, 0: counts never decay
+    double pruneWeight;  // Edges whose decayed count falls below this are removed
+    size_t maxPatterns;  // Memory budget in edges, 0: unlimited
+    long prunedPatterns;
+    
     // Statistics
     int totalUpdates;
-    int predictionRequests;
+    mutable int predictionRequests;
     int successfulPredictions;
-    
+
 public:
     // Constructors
     PatternTable(double threshold = 0.1, int maxPred = 5);
@@ -49,16 +108,19 @@ public:
     void recordTransition(int fromPage, int toPage);
     void recordSequence(const std::vector<int>& pageSequence);
     void updatePattern(int fromPage, int toPage, int count = 1);
+    void recordContextTransition(const std::vector<int>& context, int toPage);  // context ends with fromPage
     
     // Pattern prediction methods
     std::vector<int> getPredictions(int currentPage) const;
     std::vector<std::pair<int, double>> getPredictionsWithConfidence(int currentPage) const;
+    int getTopPredictions(int currentPage, int k, Predictions& result) const;  // O(k), reuses result's storage
+    std::vector<std::pair<int, double>> getPredictionsWithConfidence(const std::vector<int>& context, int* orderUsed = nullptr) const;
     int getMostLikelyNextPage(int currentPage) const;
     double getTransitionProbability(int fromPage, int toPage) const;
     
-    // Pattern analysis methods
-    int getTransitionCount(int fromPage, int toPage) const;
-    int getTotalTransitionsFrom(int fromPage) const;
+    // Pattern analysis methods (counts are decayed to the current simulation time)
+    double getTransitionCount(int fromPage, int toPage) const;
+    double getTotalTransitionsFrom(int fromPage) const;
     std::vector<PageTransition> getTopTransitions(int limit = 10) const;
     std::vector<int> getReachablePages(int fromPage) const;
     
@@ -66,13 +128,19 @@ public:
     void setConfidenceThreshold(double threshold) { confidenceThreshold = threshold; }
     void setMaxPredictions(int maxPred) { maxPredictions = maxPred; }
     void setEnableLearning(bool enable) { enableLearning = enable; }
+    void setContextModel(int maxOrder, int maxNodes = 4096, int minSupport = 3);  // Clears learned contexts
+    void setDecay(double halfLife, size_t patternBudget = 0, double minWeight = 0.05);  // halfLife in s, 0 = off
     
     // Getters
     double getConfidenceThreshold() const { return confidenceThreshold; }
     int getMaxPredictions() const { return maxPredictions; }
     bool isLearningEnabled() const { return enableLearning; }
     int getTotalTransitions() const { return totalTransitions; }
-    size_t getPatternCount() const { return transitions.size(); }
+    size_t getPatternCount() const { return patternCount; }
+    int getContextOrder() const { return contextOrder; }
+    double getHalfLife() const;  // 0 if counts do not decay
+    long getPrunedPatterns() const { return prunedPatterns; }
+    const ContextTrie& getContextTrie() const { return contextTrie; }
     
     // Statistics methods
     int getTotalUpdates() const { return totalUpdates; }
@@ -82,27 +150,40 @@ public:
     
     // Maintenance methods
     void clear();  // Clear all patterns
-    void clearPredictionsCache();  // Clear cached predictions
-    void compact(int minCount = 1);  // Remove patterns with count < minCount
+    void compact(double minCount = 1);  // Remove patterns with (decayed) count < minCount
     void decay(double factor = 0.9);  // Apply decay factor to all counts
     
-    // Persistence methods (for saving/loading patterns)
+    // Persistence methods (binary snapshot of the first-order edges, see PatternTable.cc)
     std::string serialize() const;
     bool deserialize(const std::string& data);
+    bool deserialize(const char* data, size_t length);  // Decodes in place, e.g. from a mapped file
+    bool saveSnapshot(const std::string& path) const;  // Written atomically (temp file + rename)
+    bool loadSnapshot(const std::string& path);  // Replaces the edges; false if missing or corrupt
     
     // Debug and utility methods
     std::string toString() const;
     void printStatistics() const;
     void printTopPatterns(int limit = 20) const;
     
-    // Iterator support for external analysis
-    TransitionMap::const_iterator begin() const { return transitions.begin(); }
-    TransitionMap::const_iterator end() const { return transitions.end(); }
-    
+    // Adjacency access for external analysis
+    const std::vector<OutEdge>& getOutgoingEdges(int fromPage) const;
+
 private:
     // Helper methods
-    void updatePredictionsCache(int fromPage);
     bool isValidPage(int pageId) const;
+    const SourceEntry* findSource(int fromPage) const;
+    SourceEntry& getOrCreateSource(int fromPage);
+    int findEdge(const SourceEntry& source, int toPage) const;  // Index in source.edges, -1 if absent
+    int appendEdge(SourceEntry& source, int toPage, double count);  // Caller keeps edges sorted
+    int getOrCreateEdge(SourceEntry& source, int toPage);  // Index of the edge in source.edges
+    void addToEdge(SourceEntry& source, int index, double count);  // Keeps edges sorted
+    
+    // Decay helpers
+    double incrementWeight(SourceEntry& source);  // Weight of one transition now, may move the landmark
+    double currentScale(const SourceEntry& source) const;  // Landmark weight -> current count
+    void pruneTail(SourceEntry& source, double minWeight);  // Drop trailing edges below minWeight (current)
+    void popEdge(SourceEntry& source);  // Drop the weakest edge of a source
+    void enforceBudget();
     std::vector<std::pair<int, double>> calculateProbabilities(int fromPage) const;
 };
 
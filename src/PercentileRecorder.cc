@@ -0,0 +1,41 @@
+#include <omnetpp.h>
+#include <string>
+#include "HdrHistogram.h"
+
+using namespace omnetpp;
+
+/**
+ * Result recorder for streaming latency percentiles
+ * Enabled with record=percentiles on a @statistic of times in seconds.
+ * Values go into an HdrHistogram (1us..100s, 2 significant digits, ~20 KB
+ * per statistic), so memory stays constant however long the run is; at
+ * finish the statistic's p50, p90, p99 and p99.9 are written as scalars,
+ * e.g. responseTime:p99.
+ */
+class PercentileRecorder : public cNumericResultRecorder
+{
+private:
+    HdrHistogram histogram;
+
+protected:
+    virtual void collect(simtime_t_cref, double value, cObject *) override
+    {
+        histogram.record(value);
+    }
+    
+    virtual void finish(cResultFilter *) override
+    {
+        static const double percentiles[] = {50, 90, 99, 99.9};
+        static const char *suffixes[] = {":p50", ":p90", ":p99", ":p99.9"};
+        
+        if (histogram.getCount() == 0) {
+            return;
+        }
+        std::string statName = getStatisticName();
+        for (int i = 0; i < 4; i++) {
+            getComponent()->recordScalar((statName + suffixes[i]).c_str(), histogram.getValueAtPercentile(percentiles[i]));
+        }
+    }
+};
+
+Register_ResultRecorder("percentiles", PercentileRecorder);
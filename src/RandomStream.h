@@ -0,0 +1,56 @@
+#ifndef RANDOMSTREAM_H
+#define RANDOMSTREAM_H
+
+#include <omnetpp.h>
+#include <cstdint>
+
+using namespace omnetpp;
+
+/**
+ * Counter-based random stream for common-random-numbers comparisons
+ * Draw n of a stream is SplitMix64 of its key and n, so it depends only on
+ * the key and the stream's own position, never on what other clients or code
+ * paths drew before. Keys come from a module-local OMNeT++ RNG at
+ * initialization, so seed-set and rng-N mappings apply; substream(id) gives
+ * an independent stream per user, navigation or request without any state.
+ * Works as a UniformRandomBitGenerator with the std:: distributions.
+ */
+class RandomStream
+{
+private:
+    uint64_t key;
+    uint64_t position;
+
+public:
+    typedef uint64_t result_type;
+    
+    // Constructors
+    RandomStream() : key(0), position(0) {}
+    explicit RandomStream(uint64_t streamKey) : key(streamKey), position(0) {}
+    
+    // Seeding: two 32-bit draws of an OMNeT++ RNG
+    void seed(cRNG *rng)
+    {
+        uint64_t high = rng->intRand();
+        uint64_t low = rng->intRand();
+        key = (high << 32) | low;
+        position = 0;
+    }
+    RandomStream substream(uint64_t id) const { return RandomStream(mix(key ^ mix(id + 0x632be59bd9b4e019ULL))); }
+    
+    // Random numbers
+    result_type operator()() { return mix(key + 0x9e3779b97f4a7c15ULL * ++position); }
+    double uniform(double a, double b) { return a + (b - a) * ((*this)() >> 11) * (1.0 / 9007199254740992.0); }
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT64_MAX; }
+
+private:
+    static uint64_t mix(uint64_t z)
+    {
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+};
+
+#endif // RANDOMSTREAM_H
@@ -0,0 +1,373 @@
+#include "ResponseCache.h"
+#include <algorithm>
+#include <functional>
+
+// Constructors
+ResponseCache::ResponseCache(int maxEntries)
+{
+    head = nullptr;
+    tail = nullptr;
+    nextSerial = 1;
+    capacity = maxEntries;
+    bytes = 0;
+    byteCapacity = 0;
+    policy = nullptr;
+    admissionFilter = nullptr;
+    removalListener = nullptr;
+}
+
+// Destructor
+ResponseCache::~ResponseCache()
+{
+    // Nodes are owned by the hash map
+    delete policy;
+    delete admissionFilter;
+}
+
+// Lookup methods
+CacheEntry* ResponseCache::find(int resourceId)
+{
+    auto it = nodes.find(resourceId);
+    return (it != nodes.end()) ? &it->second.entry : nullptr;
+}
+
+bool ResponseCache::touch(int resourceId)
+{
+    auto it = nodes.find(resourceId);
+    if (it == nodes.end()) {
+        return false;
+    }
+    
+    Node* node = &it->second;
+    node->entry.updateAccess();
+    if (node != head) {
+        unlink(node);
+        linkFront(node);
+    }
+    if (policy) {
+        policy->onAccess(resourceId);
+    }
+    return true;
+}
+
+void ResponseCache::recordRequest(int resourceId)
+{
+    if (policy) {
+        policy->onRequest(resourceId);
+    }
+    if (admissionFilter) {
+        admissionFilter->recordRequest(resourceId);
+    }
+}
+
+CacheEntry* ResponseCache::lookup(int resourceId, bool& expired)
+{
+    expired = false;
+    CacheEntry* entry = find(resourceId);
+    if (!entry) {
+        return nullptr;
+    }
+    
+    // The expiry heap may not have been drained yet
+    if (entry->isExpired()) {
+        erase(resourceId, CacheRemovalListener::EXPIRED);
+        expired = true;
+        return nullptr;
+    }
+    touch(resourceId);
+    return entry;
+}
+
+// Modification methods
+ResponseCache::AddResult ResponseCache::add(const CacheEntry& entry, simtime_t now, double admissionWeight, int& expired)
+{
+    int resourceId = entry.getResourceId();
+    size_t entryBytes = entry.getMemorySize();
+    expired = 0;
+    
+    if (!fits(entryBytes)) {
+        return TOO_LARGE;
+    }
+    
+    // Replacing an existing entry frees its own room
+    if (!hasRoomFor(resourceId, entryBytes)) {
+        // First drop entries that are already due
+        expired = expire(now);
+        
+        // If still full, the policy's victim must be worth displacing
+        if (!hasRoomFor(resourceId, entryBytes)) {
+            if (!admit(resourceId, admissionWeight, entryBytes)) {
+                return NOT_ADMITTED;
+            }
+            // A large entry may need several victims to fit the byte budget
+            while (!hasRoomFor(resourceId, entryBytes) && !empty()) {
+                evict(resourceId);
+            }
+        }
+    }
+    
+    insert(entry);
+    return ADDED;
+}
+
+CacheEntry& ResponseCache::insert(const CacheEntry& entry)
+{
+    int resourceId = entry.getResourceId();
+    auto result = nodes.emplace(resourceId, Node());
+    Node& node = result.first->second;
+    
+    if (!result.second) {
+        unlink(&node);  // Replacing an existing entry
+        bytes -= node.bytes;
+        if (removalListener) {
+            removalListener->onCacheRemoval(node.entry, CacheRemovalListener::REPLACED);
+        }
+    }
+    node.entry = entry;
+    node.bytes = entry.getMemorySize();
+    bytes += node.bytes;
+    linkFront(&node);
+    
+    if (entry.getTtl() > 0) {
+        node.expiryTime = entry.getTimestamp() + entry.getTtl();
+        pushExpiry(resourceId, node);
+    } else {
+        node.expirySerial = 0;  // Never expires; invalidates any older heap record
+    }
+    
+    if (policy) {
+        policy->setEntryCost(resourceId, node.bytes, entry.getGenerationCost());
+        policy->onInsert(resourceId);
+    }
+    return node.entry;
+}
+
+bool ResponseCache::erase(int resourceId, CacheRemovalListener::Cause cause)
+{
+    if (!contains(resourceId)) {
+        return false;
+    }
+    
+    if (policy) {
+        policy->onRemove(resourceId);
+    }
+    removeNode(resourceId, cause);
+    return true;
+}
+
+int ResponseCache::selectVictim(int incomingId) const
+{
+    if (policy) {
+        int victim = policy->selectVictim(incomingId);
+        if (victim >= 0 && contains(victim)) {
+            return victim;
+        }
+    }
+    return getLeastRecentlyUsed();
+}
+
+bool ResponseCache::admit(int candidateId, double weight, size_t candidateBytes) const
+{
+    if (!admissionFilter || hasRoomFor(candidateId, candidateBytes) || contains(candidateId)) {
+        return true;  // Nothing has to be displaced
+    }
+    return admissionFilter->admit(candidateId, selectVictim(candidateId), weight);
+}
+
+int ResponseCache::evict(int incomingId)
+{
+    int victim = selectVictim(incomingId);
+    if (victim < 0) {
+        return -1;
+    }
+    
+    if (policy) {
+        policy->onEvict(victim);
+    }
+    removeNode(victim, CacheRemovalListener::EVICTED);
+    return victim;
+}
+
+int ResponseCache::expire(simtime_t now)
+{
+    int expiredCount = 0;
+    
+    while (!expiryHeap.empty() && expiryHeap.front().expiryTime <= now) {
+        ExpiryRecord record = expiryHeap.front();
+        std::pop_heap(expiryHeap.begin(), expiryHeap.end(), std::greater<ExpiryRecord>());
+        expiryHeap.pop_back();
+        
+        auto it = nodes.find(record.resourceId);
+        if (it != nodes.end() && it->second.expirySerial == record.serial) {
+            if (policy) {
+                policy->onRemove(record.resourceId);
+            }
+            if (removalListener) {
+                removalListener->onCacheRemoval(it->second.entry, CacheRemovalListener::EXPIRED);
+            }
+            unlink(&it->second);
+            bytes -= it->second.bytes;
+            nodes.erase(it);
+            expiredCount++;
+        }
+    }
+    
+    return expiredCount;
+}
+
+void ResponseCache::updateSize(int resourceId)
+{
+    auto it = nodes.find(resourceId);
+    if (it == nodes.end()) {
+        return;
+    }
+    
+    Node& node = it->second;
+    bytes -= node.bytes;
+    node.bytes = node.entry.getMemorySize();
+    bytes += node.bytes;
+    if (policy) {
+        policy->setEntryCost(resourceId, node.bytes, node.entry.getGenerationCost());
+    }
+}
+
+void ResponseCache::clear()
+{
+    nodes.clear();
+    expiryHeap.clear();
+    bytes = 0;
+    head = nullptr;
+    tail = nullptr;
+    if (policy) {
+        policy->clear();
+    }
+    if (admissionFilter) {
+        admissionFilter->clear();
+    }
+}
+
+// Policy configuration
+void ResponseCache::setPolicy(EvictionPolicy* evictionPolicy)
+{
+    delete policy;
+    policy = evictionPolicy;
+    for (Node* node = tail; node; node = node->prev) {
+        if (policy) {
+            // Seed in LRU-to-MRU order
+            policy->setEntryCost(node->entry.getResourceId(), node->bytes, node->entry.getGenerationCost());
+            policy->onInsert(node->entry.getResourceId());
+        }
+    }
+}
+
+void ResponseCache::setAdmissionFilter(AdmissionFilter* filter)
+{
+    delete admissionFilter;
+    admissionFilter = filter;
+}
+
+bool ResponseCache::hasRoomFor(int resourceId, size_t entryBytes) const
+{
+    auto it = nodes.find(resourceId);
+    bool replacing = (it != nodes.end());
+    if (!replacing && isFull()) {
+        return false;
+    }
+    if (byteCapacity == 0) {
+        return true;
+    }
+    size_t freed = replacing ? it->second.bytes : 0;
+    return bytes - freed + entryBytes <= byteCapacity;
+}
+
+// Expiry scheduling support
+bool ResponseCache::hasPendingExpiry()
+{
+    dropStaleExpiries();
+    return !expiryHeap.empty();
+}
+
+simtime_t ResponseCache::getNextExpiry()
+{
+    dropStaleExpiries();
+    return expiryHeap.empty() ? SIMTIME_ZERO : expiryHeap.front().expiryTime;
+}
+
+// Private helper methods
+void ResponseCache::linkFront(Node* node)
+{
+    node->prev = nullptr;
+    node->next = head;
+    if (head) {
+        head->prev = node;
+    }
+    head = node;
+    if (!tail) {
+        tail = node;
+    }
+}
+
+void ResponseCache::unlink(Node* node)
+{
+    if (node->prev) {
+        node->prev->next = node->next;
+    } else if (head == node) {
+        head = node->next;
+    }
+    
+    if (node->next) {
+        node->next->prev = node->prev;
+    } else if (tail == node) {
+        tail = node->prev;
+    }
+    
+    node->prev = nullptr;
+    node->next = nullptr;
+}
+
+void ResponseCache::removeNode(int resourceId, CacheRemovalListener::Cause cause)
+{
+    auto it = nodes.find(resourceId);
+    if (removalListener) {
+        removalListener->onCacheRemoval(it->second.entry, cause);
+    }
+    unlink(&it->second);
+    bytes -= it->second.bytes;
+    nodes.erase(it);  // Its heap record becomes stale and is skipped later
+}
+
+void ResponseCache::pushExpiry(int resourceId, Node& node)
+{
+    // Too many stale records: rebuild from live nodes (amortized O(1) per operation)
+    if (expiryHeap.size() > 2 * nodes.size() + 64) {
+        rebuildExpiryHeap();
+    }
+    
+    node.expirySerial = nextSerial++;
+    expiryHeap.push_back(ExpiryRecord{node.expiryTime, resourceId, node.expirySerial});
+    std::push_heap(expiryHeap.begin(), expiryHeap.end(), std::greater<ExpiryRecord>());
+}
+
+void ResponseCache::dropStaleExpiries()
+{
+    while (!expiryHeap.empty()) {
+        const ExpiryRecord& record = expiryHeap.front();
+        auto it = nodes.find(record.resourceId);
+        if (it != nodes.end() && it->second.expirySerial == record.serial) {
+            return;  // Top record is live
+        }
+        std::pop_heap(expiryHeap.begin(), expiryHeap.end(), std::greater<ExpiryRecord>());
+        expiryHeap.pop_back();
+    }
+}
+
+void ResponseCache::rebuildExpiryHeap()
+{
+    expiryHeap.clear();
+    for (const auto& pair : nodes) {
+        if (pair.second.expirySerial != 0) {
+            expiryHeap.push_back(ExpiryRecord{pair.second.expiryTime, pair.first, pair.second.expirySerial});
+        }
+    }
+    std::make_heap(expiryHeap.begin(), expiryHeap.end(), std::greater<ExpiryRecord>());
+}
@@ -0,0 +1,143 @@
+#ifndef RESPONSECACHE_H
+#define RESPONSECACHE_H
+
+#include <omnetpp.h>
+#include <unordered_map>
+#include <vector>
+#include "CacheEntry.h"
+#include "CachePolicy.h"
+
+using namespace omnetpp;
+
+/**
+ * Receives entries as they leave a ResponseCache (clear() does not notify)
+ */
+class CacheRemovalListener
+{
+public:
+    enum Cause { EXPIRED, EVICTED, REPLACED, ERASED };
+    
+    virtual ~CacheRemovalListener() {}
+    virtual void onCacheRemoval(const CacheEntry& entry, Cause cause) = 0;
+};
+
+/**
+ * Response cache keyed by resourceId
+ * Entries live in a hash map and are also linked into an intrusive
+ * doubly-linked LRU list; TTL expiry is tracked by a single min-heap
+ * so the owner only needs one self-message for the earliest expiry.
+ * Lookup, touch and eviction are O(1), expiry is O(log n) amortized.
+ * An optional EvictionPolicy replaces the LRU victim choice, and an
+ * optional AdmissionFilter can refuse entries that would displace hotter ones.
+ * A CacheRemovalListener is told about every entry that leaves the cache.
+ * Besides the entry limit, an optional byte budget caps the summed
+ * CacheEntry::getMemorySize() of all entries.
+ */
+class ResponseCache
+{
+private:
+    // Cache node: entry plus intrusive LRU links
+    struct Node {
+        CacheEntry entry;
+        size_t bytes;  // entry.getMemorySize() when inserted
+        simtime_t expiryTime;
+        unsigned long expirySerial;  // Matches the live heap record for this node
+        Node* prev;  // Towards most recently used
+        Node* next;  // Towards least recently used
+        
+        Node() : bytes(0), expiryTime(SIMTIME_ZERO), expirySerial(0), prev(nullptr), next(nullptr) {}
+    };
+    
+    // Heap record; stale records (erased or re-inserted entries) are skipped lazily
+    struct ExpiryRecord {
+        simtime_t expiryTime;
+        int resourceId;
+        unsigned long serial;
+        
+        bool operator>(const ExpiryRecord& other) const { return expiryTime > other.expiryTime; }
+    };
+    
+    std::unordered_map<int, Node> nodes;  // resourceId -> node (references stay valid on rehash)
+    Node* head;  // Most recently used
+    Node* tail;  // Least recently used
+    std::vector<ExpiryRecord> expiryHeap;  // Min-heap on expiryTime
+    unsigned long nextSerial;
+    int capacity;
+    size_t bytes;  // Sum of Node::bytes
+    size_t byteCapacity;  // 0: no byte budget
+    EvictionPolicy* policy;  // nullptr: plain LRU on the intrusive list
+    AdmissionFilter* admissionFilter;  // nullptr: admit everything
+    CacheRemovalListener* removalListener;  // Not owned, may be nullptr
+
+public:
+    // Outcome of add()
+    enum AddResult {
+        ADDED,
+        TOO_LARGE,  // Larger than the whole byte budget
+        NOT_ADMITTED  // The admission filter kept the eviction victim
+    };
+    
+    // Constructors
+    ResponseCache(int maxEntries = 20);
+    
+    // Destructor
+    ~ResponseCache();
+    
+    // Lookup methods
+    CacheEntry* find(int resourceId);  // No recency update, may return an expired entry
+    bool contains(int resourceId) const { return nodes.find(resourceId) != nodes.end(); }
+    bool touch(int resourceId);  // Update access statistics and move to MRU position
+    void recordRequest(int resourceId);  // Feed demand frequency to policy and admission filter
+    CacheEntry* lookup(int resourceId, bool& expired);  // Fresh entry (touched), or nullptr; an expired one is erased
+    
+    // Modification methods
+    CacheEntry& insert(const CacheEntry& entry);  // Insert or replace, entry becomes MRU
+    AddResult add(const CacheEntry& entry, simtime_t now, double admissionWeight, int& expired);  // Make room (expire, admit, evict), then insert
+    bool erase(int resourceId, CacheRemovalListener::Cause cause = CacheRemovalListener::ERASED);
+    int selectVictim(int incomingId = -1) const;  // Entry the next eviction would remove, or -1
+    bool admit(int candidateId, double weight = 1.0, size_t candidateBytes = 0) const;  // May candidate displace the victim?
+    int evict(int incomingId = -1);  // Returns evicted resourceId, or -1 if empty
+    int expire(simtime_t now);  // Remove all entries expired at 'now', returns count
+    void updateSize(int resourceId);  // Re-account an entry whose getMemorySize() changed in place
+    void clear();
+    
+    // Policy configuration (the cache takes ownership)
+    void setPolicy(EvictionPolicy* evictionPolicy);
+    void setAdmissionFilter(AdmissionFilter* filter);
+    const char* getPolicyName() const { return policy ? policy->getName() : "lru"; }
+    void setRemovalListener(CacheRemovalListener* listener) { removalListener = listener; }
+    
+    // Expiry scheduling support
+    bool hasPendingExpiry();
+    simtime_t getNextExpiry();  // Earliest pending expiry time (only valid if hasPendingExpiry())
+    
+    // Getters and setters
+    int size() const { return nodes.size(); }
+    bool empty() const { return nodes.empty(); }
+    bool isFull() const { return static_cast<int>(nodes.size()) >= capacity; }
+    bool hasRoomFor(int resourceId, size_t entryBytes) const;  // Within both limits, counting a replaced entry as freed
+    bool fits(size_t entryBytes) const { return byteCapacity == 0 || entryBytes <= byteCapacity; }
+    int getCapacity() const { return capacity; }
+    void setCapacity(int maxEntries) { capacity = maxEntries; }
+    size_t getBytes() const { return bytes; }
+    size_t getByteCapacity() const { return byteCapacity; }
+    void setByteCapacity(size_t maxBytes) { byteCapacity = maxBytes; }
+    int getLeastRecentlyUsed() const { return tail ? tail->entry.getResourceId() : -1; }
+
+private:
+    // Non-copyable: nodes are linked by pointer
+    ResponseCache(const ResponseCache& other);
+    ResponseCache& operator=(const ResponseCache& other);
+    
+    // Intrusive list helpers
+    void linkFront(Node* node);
+    void unlink(Node* node);
+    void removeNode(int resourceId, CacheRemovalListener::Cause cause);
+    
+    // Heap helpers
+    void pushExpiry(int resourceId, Node& node);
+    void dropStaleExpiries();
+    void rebuildExpiryHeap();
+};
+
+#endif // RESPONSECACHE_H
@@ -0,0 +1,127 @@
+#include "SessionPredictor.h"
+#include <algorithm>
+
+// Constructors
+SessionPredictor::SessionPredictor(int length, int support)
+{
+    historyLength = length;
+    minSupport = support;
+    activeSessions = 0;
+}
+
+void SessionPredictor::configure(int length, int support)
+{
+    if (length < 2) {
+        throw cRuntimeError("Session history length must be at least 2, got %d", length);
+    }
+    if (support < 1) {
+        throw cRuntimeError("Session minimum support must be at least 1, got %d", support);
+    }
+    
+    historyLength = length;
+    minSupport = support;
+    clear();
+}
+
+// Learning and prediction
+void SessionPredictor::recordVisit(int clientId, int page)
+{
+    if (clientId < 0 || page < 0) {
+        return;
+    }
+    
+    if (clientId >= static_cast<int>(sessions.size())) {
+        sessions.resize(clientId + 1);
+    }
+    
+    Session& session = sessions[clientId];
+    if (session.history.empty()) {
+        session.history.assign(historyLength, -1);
+        activeSessions++;
+    }
+    
+    session.history[session.head] = page;
+    session.head = (session.head + 1) % historyLength;
+    if (session.count < historyLength) {
+        session.count++;
+    }
+}
+
+bool SessionPredictor::predict(int clientId, int currentPage, Predictions& predictions) const
+{
+    predictions.clear();
+    const Session* session = findSession(clientId);
+    if (!session || session->count < 2) {
+        return false;
+    }
+    
+    // Walk consecutive pairs oldest to newest; count successors of currentPage
+    int support = 0;
+    int start = (session->head - session->count + historyLength) % historyLength;
+    for (int k = 0; k + 1 < session->count; k++) {
+        int from = session->history[(start + k) % historyLength];
+        int to = session->history[(start + k + 1) % historyLength];
+        if (from != currentPage || to == from) {
+            continue;  // Self-transitions are skipped like in the global table
+        }
+        
+        support++;
+        auto it = std::find_if(predictions.begin(), predictions.end(),
+                               [to](const std::pair<int, double>& p) { return p.first == to; });
+        if (it != predictions.end()) {
+            it->second += 1.0;
+        } else {
+            predictions.push_back(std::make_pair(to, 1.0));
+        }
+    }
+    
+    if (support < minSupport) {
+        predictions.clear();
+        return false;
+    }
+    
+    for (auto& prediction : predictions) {
+        prediction.second /= support;
+    }
+    std::sort(predictions.begin(), predictions.end(),
+              [](const std::pair<int, double>& a, const std::pair<int, double>& b) { return a.second > b.second; });
+    return true;
+}
+
+int SessionPredictor::getLastPage(int clientId) const
+{
+    const Session* session = findSession(clientId);
+    if (!session || session->count == 0) {
+        return -1;
+    }
+    return session->history[(session->head - 1 + historyLength) % historyLength];
+}
+
+void SessionPredictor::getRecentPages(int clientId, int maxPages, std::vector<int>& pages) const
+{
+    pages.clear();
+    const Session* session = findSession(clientId);
+    if (!session) {
+        return;
+    }
+    
+    int length = std::min(maxPages, session->count);
+    int start = (session->head - length + historyLength) % historyLength;
+    for (int k = 0; k < length; k++) {
+        pages.push_back(session->history[(start + k) % historyLength]);
+    }
+}
+
+void SessionPredictor::clear()
+{
+    sessions.clear();
+    activeSessions = 0;
+}
+
+const SessionPredictor::Session* SessionPredictor::findSession(int clientId) const
+{
+    if (clientId < 0 || clientId >= static_cast<int>(sessions.size())) {
+        return nullptr;
+    }
+    return &sessions[clientId];
+}
@@ -0,0 +1,61 @@
+#ifndef SESSIONPREDICTOR_H
+#define SESSIONPREDICTOR_H
+
+#include <omnetpp.h>
+#include <vector>
+#include <utility>
+
+using namespace omnetpp;
+
+/**
+ * Per-client next-page predictor
+ * Each client keeps a fixed-size ring buffer of its most recent pages;
+ * predictions count what this client visited after the current page in
+ * that history. Too little history (fewer than minSupport observed
+ * transitions) means no prediction, so the caller falls back to the
+ * global PatternTable.
+ */
+class SessionPredictor
+{
+public:
+    typedef std::vector<std::pair<int, double>> Predictions;  // (page, probability), most likely first
+
+private:
+    // Visit history of one client
+    struct Session {
+        std::vector<int> history;  // Ring buffer, empty until the first visit
+        int head;  // Next write position
+        int count;  // Valid entries
+        
+        Session() : head(0), count(0) {}
+    };
+    
+    std::vector<Session> sessions;  // Indexed by clientId
+    int historyLength;
+    int minSupport;
+    int activeSessions;
+
+public:
+    // Constructors
+    SessionPredictor(int length = 16, int support = 3);
+    
+    // Configuration, throws cRuntimeError on invalid values
+    void configure(int length, int support);
+    
+    // Learning and prediction
+    void recordVisit(int clientId, int page);
+    bool predict(int clientId, int currentPage, Predictions& predictions) const;  // false: too little history
+    int getLastPage(int clientId) const;  // -1 if the client has no history
+    void getRecentPages(int clientId, int maxPages, std::vector<int>& pages) const;  // Oldest first
+    void clear();
+    
+    // Getters
+    int getHistoryLength() const { return historyLength; }
+    int getMinSupport() const { return minSupport; }
+    int getSessionCount() const { return activeSessions; }
+
+private:
+    const Session* findSession(int clientId) const;
+};
+
+#endif // SESSIONPREDICTOR_H
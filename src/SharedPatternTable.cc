@@ -0,0 +1,19 @@
+#include "SharedPatternTable.h"
+
+Define_Module(SharedPatternTable);
+
+void SharedPatternTable::initialize()
+{
+    table.clear();
+}
+
+void SharedPatternTable::handleMessage(cMessage *msg)
+{
+    throw cRuntimeError("SharedPatternTable does not process messages (got '%s')", msg->getName());
+}
+
+void SharedPatternTable::finish()
+{
+    recordScalar("totalPatterns", table.getPatternCount());
+    EV << "SharedPatternTable: " << table.getPatternCount() << " transitions learned" << endl;
+}
@@ -0,0 +1,28 @@
+#ifndef SHAREDPATTERNTABLE_H
+#define SHAREDPATTERNTABLE_H
+
+#include <omnetpp.h>
+#include "PatternTable.h"
+
+using namespace omnetpp;
+
+/**
+ * Holder module for a PatternTable shared by several HttpServer shards
+ * Shards whose sharedPatternTable parameter points here learn into and
+ * predict from this one table instead of their own.
+ */
+class SharedPatternTable : public cSimpleModule
+{
+private:
+    PatternTable table;
+
+protected:
+    virtual void initialize() override;
+    virtual void handleMessage(cMessage *msg) override;
+    virtual void finish() override;
+
+public:
+    PatternTable* getTable() { return &table; }
+};
+
+#endif // SHAREDPATTERNTABLE_H
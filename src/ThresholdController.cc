@@ -0,0 +1,106 @@
+#include "ThresholdController.h"
+#include <algorithm>
+
+// Constructors
+ThresholdController::ThresholdController()
+{
+    threshold = 0.6;
+    minThreshold = 0.0;
+    maxThreshold = 1.0;
+    targetPrecision = 0.6;
+    gain = 0.2;
+    adaptTtl = false;
+    ttl = 0;
+    minTtl = 0;
+    maxTtl = 0;
+    intervalUseful = 0;
+    intervalExpired = 0;
+    intervalEvicted = 0;
+    precision = -1;
+    adjustments = 0;
+}
+
+// Configuration
+void ThresholdController::configure(double initialThreshold, double lowerBound, double upperBound, double target, double controlGain)
+{
+    if (lowerBound > upperBound) {
+        throw cRuntimeError("ThresholdController: lower bound %g exceeds upper bound %g", lowerBound, upperBound);
+    }
+    minThreshold = lowerBound;
+    maxThreshold = upperBound;
+    threshold = std::min(std::max(initialThreshold, minThreshold), maxThreshold);
+    targetPrecision = target;
+    gain = controlGain;
+}
+
+void ThresholdController::configureTtl(int initialTtl, int lowerBound, int upperBound)
+{
+    if (lowerBound < 1 || lowerBound > upperBound) {
+        throw cRuntimeError("ThresholdController: invalid TTL bounds [%d, %d]", lowerBound, upperBound);
+    }
+    adaptTtl = true;
+    minTtl = lowerBound;
+    maxTtl = upperBound;
+    ttl = std::min(std::max(initialTtl, minTtl), maxTtl);
+}
+
+// Prefetch outcomes
+void ThresholdController::recordUseful()
+{
+    intervalUseful++;
+}
+
+void ThresholdController::recordWasted(bool expired)
+{
+    if (expired) {
+        intervalExpired++;
+    } else {
+        intervalEvicted++;
+    }
+}
+
+// Control step
+bool ThresholdController::update(double cachePressure, long requests)
+{
+    double oldThreshold = threshold;
+    int oldTtl = ttl;
+    long wasted = intervalExpired + intervalEvicted;
+    long outcomes = intervalUseful + wasted;
+    
+    if (outcomes >= MIN_OUTCOMES) {
+        precision = static_cast<double>(intervalUseful) / outcomes;
+        
+        // Too many wasted prefetches raise the threshold, faster when they displace demand entries
+        double error = targetPrecision - precision;
+        double weight = (error > 0) ? 1.0 + cachePressure : 1.0 - 0.5 * cachePressure;
+        threshold += gain * error * weight;
+        
+        // Waste by expiry: entries die before the predicted visit, keep them longer
+        // if there is room; waste by eviction: free slots sooner
+        if (adaptTtl && error > 0) {
+            if (intervalExpired > intervalEvicted && cachePressure < 0.9) {
+                ttl++;
+            } else if (intervalEvicted > intervalExpired) {
+                ttl--;
+            }
+        }
+    } else if (requests > 0 && cachePressure < 1.0) {
+        // Traffic but (almost) nothing pre-cached: probe downwards so feedback resumes
+        threshold -= 0.1 * gain * (threshold - minThreshold);
+    }
+    
+    threshold = std::min(std::max(threshold, minThreshold), maxThreshold);
+    if (adaptTtl) {
+        ttl = std::min(std::max(ttl, minTtl), maxTtl);
+    }
+    
+    intervalUseful = 0;
+    intervalExpired = 0;
+    intervalEvicted = 0;
+    
+    bool changed = (threshold != oldThreshold || ttl != oldTtl);
+    if (changed) {
+        adjustments++;
+    }
+    return changed;
+}
@@ -0,0 +1,62 @@
+#ifndef THRESHOLDCONTROLLER_H
+#define THRESHOLDCONTROLLER_H
+
+#include <omnetpp.h>
+
+using namespace omnetpp;
+
+/**
+ * Feedback controller for the pre-caching threshold
+ * Once per control interval the precision of pre-cached entries (hit before
+ * they expired or were evicted, versus wasted) is compared with a target
+ * and the threshold moves proportionally within bounds; a full cache makes
+ * wasted prefetches weigh more. Optionally the cache TTL is steered too.
+ */
+class ThresholdController
+{
+private:
+    // Controlled values and their bounds
+    double threshold;
+    double minThreshold;
+    double maxThreshold;
+    double targetPrecision;
+    double gain;  // Threshold change per unit of precision error
+    bool adaptTtl;
+    int ttl;
+    int minTtl;
+    int maxTtl;
+    
+    // Prefetch outcomes in the current interval
+    long intervalUseful;
+    long intervalExpired;  // Wasted: expired before any hit
+    long intervalEvicted;  // Wasted: evicted or replaced before any hit
+    double precision;  // Of the last interval with enough outcomes, -1 before that
+    
+    long adjustments;
+    
+    static const int MIN_OUTCOMES = 5;  // Fewer outcomes per interval are too noisy to act on
+
+public:
+    // Constructors
+    ThresholdController();
+    
+    // Configuration
+    void configure(double initialThreshold, double lowerBound, double upperBound, double target, double controlGain);
+    void configureTtl(int initialTtl, int lowerBound, int upperBound);  // Enables TTL steering
+    
+    // Prefetch outcomes
+    void recordUseful();
+    void recordWasted(bool expired);
+    
+    // Control step; cachePressure is the cache fill level (0-1), requests the demand in the interval
+    bool update(double cachePressure, long requests);  // True if threshold or TTL changed
+    
+    // Getters
+    double getThreshold() const { return threshold; }
+    int getTtl() const { return ttl; }
+    bool isTtlAdaptive() const { return adaptTtl; }
+    double getIntervalPrecision() const { return precision; }
+    long getAdjustments() const { return adjustments; }
+};
+
+#endif // THRESHOLDCONTROLLER_H
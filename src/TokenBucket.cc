@@ -0,0 +1,63 @@
+#include "TokenBucket.h"
+#include <algorithm>
+
+// Constructors
+TokenBucket::TokenBucket()
+{
+    rate = 0.0;
+    burst = 0.0;
+    tokens = 0.0;
+    lastRefill = SIMTIME_ZERO;
+}
+
+// Configuration
+void TokenBucket::configure(double tokensPerSecond, double bucketSize, simtime_t now)
+{
+    if (tokensPerSecond < 0 || bucketSize < 0) {
+        throw cRuntimeError("TokenBucket: rate and bucket size must not be negative");
+    }
+    rate = tokensPerSecond;
+    burst = bucketSize;
+    tokens = burst;
+    lastRefill = now;
+}
+
+// Operations
+bool TokenBucket::tryConsume(double cost, simtime_t now)
+{
+    if (!isLimited()) {
+        return true;
+    }
+    
+    refill(now);
+    if (tokens < cost) {
+        return false;
+    }
+    tokens -= cost;
+    return true;
+}
+
+void TokenBucket::refund(double cost, simtime_t now)
+{
+    if (!isLimited()) {
+        return;
+    }
+    
+    refill(now);
+    tokens = std::min(burst, tokens + cost);
+}
+
+double TokenBucket::getTokens(simtime_t now)
+{
+    refill(now);
+    return tokens;
+}
+
+// Private helper methods
+void TokenBucket::refill(simtime_t now)
+{
+    if (now > lastRefill) {
+        tokens = std::min(burst, tokens + rate * SIMTIME_DBL(now - lastRefill));
+        lastRefill = now;
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef TOKENBUCKET_H
+#define TOKENBUCKET_H
+
+#include <omnetpp.h>
+
+using namespace omnetpp;
+
+/**
+ * Token bucket rate limiter in simulated time
+ * Tokens accrue at 'rate' per simulated second up to 'burst'; an operation
+ * only runs if it can pay its cost. A rate of 0 means unlimited.
+ */
+class TokenBucket
+{
+private:
+    double rate;  // Tokens per simulated second, 0: unlimited
+    double burst;  // Bucket size
+    double tokens;
+    simtime_t lastRefill;
+
+public:
+    // Constructors
+    TokenBucket();
+    
+    // Configuration (starts with a full bucket)
+    void configure(double tokensPerSecond, double bucketSize, simtime_t now);
+    
+    // Operations
+    bool tryConsume(double cost, simtime_t now);  // Pays and returns true if enough tokens are available
+    void refund(double cost, simtime_t now);  // Returns tokens of work that did not happen, up to the bucket size
+    
+    // Getters
+    bool isLimited() const { return rate > 0; }
+    double getRate() const { return rate; }
+    double getTokens(simtime_t now);
+
+private:
+    void refill(simtime_t now);
+};
+
+#endif // TOKENBUCKET_H
@@ -0,0 +1,166 @@
+#include "TraceFile.h"
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Constructors
+TraceFile::TraceFile()
+{
+    mapping = nullptr;
+    mappedBytes = 0;
+    records = nullptr;
+    recordCount = 0;
+    position = 0;
+    releasedBytes = 0;
+    startTimeUs = 0;
+#ifdef _WIN32
+    fileHandle = INVALID_HANDLE_VALUE;
+    mappingHandle = nullptr;
+#else
+    fd = -1;
+#endif
+}
+
+// Destructor
+TraceFile::~TraceFile()
+{
+    close();
+}
+
+// Access
+void TraceFile::open(const std::string& fileName)
+{
+    close();
+    path = fileName;
+
+#ifdef _WIN32
+    fileHandle = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                             OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        throw cRuntimeError("Cannot open trace file '%s'", fileName.c_str());
+    }
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(fileHandle, &fileSize);
+    mappedBytes = static_cast<size_t>(fileSize.QuadPart);
+    if (mappedBytes >= sizeof(Header)) {
+        mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mappingHandle) {
+            mapping = static_cast<const unsigned char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+        }
+    }
+#else
+    fd = ::open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw cRuntimeError("Cannot open trace file '%s'", fileName.c_str());
+    }
+    struct stat info;
+    fstat(fd, &info);
+    mappedBytes = static_cast<size_t>(info.st_size);
+    if (mappedBytes >= sizeof(Header)) {
+        void* address = mmap(nullptr, mappedBytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address != MAP_FAILED) {
+            mapping = static_cast<const unsigned char*>(address);
+            madvise(address, mappedBytes, MADV_SEQUENTIAL);
+        }
+    }
+#endif
+
+    if (!mapping) {
+        close();
+        throw cRuntimeError("Cannot map trace file '%s' (too short or unreadable)", fileName.c_str());
+    }
+    
+    // Validate the header before trusting the record count
+    Header header;
+    std::memcpy(&header, mapping, sizeof(Header));
+    if (std::memcmp(header.magic, "HTTRACE1", 8) != 0 || header.recordSize != sizeof(Record)) {
+        close();
+        throw cRuntimeError("'%s' is not a trace file (convert access logs with tools/trace2bin.py)", fileName.c_str());
+    }
+    if (header.recordCount > (mappedBytes - sizeof(Header)) / sizeof(Record)) {
+        close();
+        throw cRuntimeError("Trace file '%s' is truncated", fileName.c_str());
+    }
+    
+    records = reinterpret_cast<const Record*>(mapping + sizeof(Header));
+    recordCount = header.recordCount;
+    startTimeUs = header.startTimeUs;
+    position = 0;
+    releasedBytes = 0;
+}
+
+void TraceFile::close()
+{
+#ifdef _WIN32
+    if (mapping) {
+        UnmapViewOfFile(mapping);
+    }
+    if (mappingHandle) {
+        CloseHandle(mappingHandle);
+        mappingHandle = nullptr;
+    }
+    if (fileHandle != INVALID_HANDLE_VALUE) {
+        CloseHandle(fileHandle);
+        fileHandle = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (mapping) {
+        munmap(const_cast<unsigned char*>(mapping), mappedBytes);
+    }
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+#endif
+    mapping = nullptr;
+    mappedBytes = 0;
+    records = nullptr;
+    recordCount = 0;
+    position = 0;
+    releasedBytes = 0;
+}
+
+const TraceFile::Record* TraceFile::next()
+{
+    if (position >= recordCount) {
+        return nullptr;
+    }
+    
+    const Record* record = &records[position++];
+    if (position % RELEASE_INTERVAL == 0) {
+        releaseConsumed();
+    }
+    return record;
+}
+
+void TraceFile::rewind()
+{
+    position = 0;
+    releasedBytes = 0;  // Released pages are faulted in again on access
+}
+
+// Private helper methods
+void TraceFile::releaseConsumed()
+{
+    // Aligned blocks wholly behind the read position
+    size_t consumed = sizeof(Header) + position * sizeof(Record);
+    size_t releasable = consumed - consumed % RELEASE_ALIGNMENT;
+    if (releasable <= releasedBytes) {
+        return;
+    }
+
+#ifdef _WIN32
+    // Unlocked pages of a read-only view can be trimmed from the working set
+    VirtualUnlock(const_cast<unsigned char*>(mapping) + releasedBytes, releasable - releasedBytes);
+#else
+    madvise(const_cast<unsigned char*>(mapping) + releasedBytes, releasable - releasedBytes, MADV_DONTNEED);
+#endif
+    releasedBytes = releasable;
+}
@@ -0,0 +1,85 @@
+#ifndef TRACEFILE_H
+#define TRACEFILE_H
+
+#include <omnetpp.h>
+#include <string>
+#include <cstdint>
+
+using namespace omnetpp;
+
+/**
+ * Memory-mapped reader for binary access traces (.htrc)
+ * Layout (little-endian): a 32-byte Header followed by recordCount fixed-size
+ * Records sorted by time. Files are produced from CLF/CSV access logs by
+ * tools/trace2bin.py. Records are read in place from the mapping, and pages
+ * already consumed are handed back to the OS every RELEASE_INTERVAL records,
+ * so resident memory stays constant however long the trace is.
+ */
+class TraceFile
+{
+public:
+    struct Header {
+        char magic[8];  // "HTTRACE1"
+        uint32_t recordSize;  // sizeof(Record)
+        uint32_t flags;  // Reserved, 0
+        uint64_t recordCount;
+        int64_t startTimeUs;  // Wall-clock time of the first record (Unix epoch), informational
+    };
+    
+    struct Record {
+        int64_t timeUs;  // Microseconds since the first record
+        uint32_t clientId;
+        uint32_t resourceId;
+        uint32_t bytes;  // Response size in the log, 0 if unknown
+        uint32_t reserved;
+    };
+    
+    static const uint64_t RELEASE_INTERVAL = 1 << 20;  // Records between releases (24 MiB)
+    static const size_t RELEASE_ALIGNMENT = 64 * 1024;  // Covers page sizes and the Windows allocation granularity
+
+private:
+    std::string path;
+    const unsigned char* mapping;  // nullptr while closed
+    size_t mappedBytes;
+    const Record* records;
+    uint64_t recordCount;
+    uint64_t position;  // Next record to read
+    size_t releasedBytes;  // Prefix of the mapping already given back
+    int64_t startTimeUs;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#else
+    int fd;
+#endif
+
+public:
+    // Constructors
+    TraceFile();
+    
+    // Destructor
+    ~TraceFile();
+    
+    // Access (open() throws cRuntimeError on missing or malformed files)
+    void open(const std::string& fileName);
+    void close();
+    const Record* next();  // nullptr at the end of the trace
+    const Record* peek() const { return position < recordCount ? &records[position] : nullptr; }
+    void rewind();
+    
+    // Getters
+    bool isOpen() const { return mapping != nullptr; }
+    uint64_t getRecordCount() const { return recordCount; }
+    uint64_t getPosition() const { return position; }
+    int64_t getStartTimeUs() const { return startTimeUs; }
+    const std::string& getPath() const { return path; }
+
+private:
+    // Non-copyable: owns the mapping
+    TraceFile(const TraceFile& other);
+    TraceFile& operator=(const TraceFile& other);
+    
+    void releaseConsumed();
+};
+
+#endif // TRACEFILE_H
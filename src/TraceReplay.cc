@@ -0,0 +1,262 @@
+#include <omnetpp.h>
+#include <string>
+#include <algorithm>
+#include <cstdint>
+#include "HttpMessage.h"
+#include "FlatHashMap.h"
+#include "TraceFile.h"
+#include "TransmissionQueue.h"
+#include "Visuals.h"
+
+using namespace omnetpp;
+
+/**
+ * Trace-driven workload
+ * Replays (time, clientId, resourceId, size) records of a binary access trace
+ * (see TraceFile) as HTTP requests over one gate pair, open-loop at the
+ * recorded times. Records are read lazily from the memory-mapped file one
+ * send time ahead, so memory grows with outstanding requests and distinct
+ * clients, never with trace length. Each request carries the same client's
+ * previous page as fromPage, so the server learns transitions from the log.
+ */
+class TraceReplay : public cSimpleModule
+{
+private:
+    // Configuration
+    std::string traceFileName;
+    double speedup;  // Trace seconds per simulated second
+    int numResources;  // > 0: resourceIds are folded onto 0..numResources-1
+    int clientIdOffset;  // Added to trace clientIds to keep them apart from other clients
+    int64_t maxRecords;  // 0 = whole trace
+    bool visualize;          // Display-string updates (configurable)
+    bool verbose;            // Per-request log lines (configurable)
+    
+    // Trace reading
+    TraceFile trace;
+    simtime_t startTime;  // Simulated time of the first record
+    cMessage *nextRecordTimer;
+    
+    // Request tracking for response time measurement
+    int requestCounter;  // Unique over the replay, used as requestId
+    FlatHashMap<simtime_t> pendingRequests;  // makeRequestKey(clientId, requestId) → send time
+    FlatHashMap<int> lastPage;  // clientId → previous page of that client
+    
+    // Output link
+    TransmissionQueue txQueue;
+    WireFormat requestFormat;  // Header bytes and TCP framing (configurable)
+    
+    // Statistics
+    long requestsSent;
+    long responsesReceived;
+    long notFound;  // 404s: trace resources the server does not know
+    int64_t traceBytes;  // Sum of the logged response sizes
+    double responseTimeSum;
+    
+    // Statistics signals
+    simsignal_t requestSentSignal;
+    simsignal_t responseReceivedSignal;
+    simsignal_t responseTimeSignal;
+    simsignal_t timeToFirstByteSignal;
+
+protected:
+    virtual void initialize() override;
+    virtual void handleMessage(cMessage *msg) override;
+    virtual void finish() override;
+    
+    // Helper methods
+    virtual void sendDueRecords();
+    virtual void scheduleNextRecord();
+    virtual void sendHttpRequest(const TraceFile::Record& record);
+    virtual void handleHttpResponse(HttpResponse *response);
+    simtime_t recordTime(const TraceFile::Record& record) const { return startTime + record.timeUs * 1e-6 / speedup; }
+};
+
+Define_Module(TraceReplay);
+
+void TraceReplay::initialize()
+{
+    // Initialize replay - READ FROM PARAMETERS
+    traceFileName = par("traceFile").stdstringValue();
+    speedup = par("speedup").doubleValue();
+    numResources = par("numResources").intValue();
+    clientIdOffset = par("clientIdOffset").intValue();
+    maxRecords = par("maxRecords").intValue();
+    visualize = par("visualize").boolValue();
+    verbose = par("verbose").boolValue();
+    if (speedup <= 0) {
+        throw cRuntimeError("speedup must be positive");
+    }
+    if (numResources < 0 || clientIdOffset < 0 || maxRecords < 0) {
+        throw cRuntimeError("numResources, clientIdOffset and maxRecords must not be negative");
+    }
+    
+    // Register statistics signals
+    requestSentSignal = registerSignal("requestSent");
+    responseReceivedSignal = registerSignal("responseReceived");
+    responseTimeSignal = registerSignal("responseTime");
+    timeToFirstByteSignal = registerSignal("timeToFirstByte");
+    requestCounter = 0;
+    requestsSent = 0;
+    responsesReceived = 0;
+    notFound = 0;
+    traceBytes = 0;
+    responseTimeSum = 0.0;
+    
+    // Initialize output link - READ FROM PARAMETERS
+    requestFormat.headerBytes = par("requestHeaderBytes").intValue();
+    requestFormat.mss = par("mss").intValue();
+    requestFormat.segmentOverhead = par("segmentOverhead").intValue();
+    if (requestFormat.mss <= 0) {
+        throw cRuntimeError("mss must be positive");
+    }
+    txQueue.init(this, gate("out"), registerSignal("txQueueingDelay"));
+    
+    // Map the trace; records are only touched when they are due
+    trace.open(traceFileName);
+    startTime = simTime() + par("startDelay").doubleValue();
+    nextRecordTimer = new cMessage("nextRecord");
+    scheduleNextRecord();
+    
+    IF_VISUALIZE {
+        getDisplayString().setTagArg("t", 0, ("Trace\n" + std::to_string(trace.getRecordCount()) + " records").c_str());
+    }
+    
+    EV << "TraceReplay opened '" << traceFileName << "' with " << trace.getRecordCount()
+       << " records at speedup " << speedup << endl;
+}
+
+void TraceReplay::handleMessage(cMessage *msg)
+{
+    if (msg->isSelfMessage()) {
+        if (msg == nextRecordTimer) {
+            sendDueRecords();
+        } else if (TransmissionQueue::isTimer(msg)) {
+            TransmissionQueue::handleTimer(msg);
+        }
+    } else {
+        // Handle HTTP response
+        HttpResponse *response = dynamic_cast<HttpResponse*>(msg);
+        if (response) {
+            handleHttpResponse(response);
+        } else {
+            EV << "ERROR: Received non-HttpResponse message: " << msg->getClassName() << endl;
+        }
+        delete msg;
+    }
+}
+
+void TraceReplay::sendDueRecords()
+{
+    // Records with equal (or out-of-order earlier) times all go out now
+    simtime_t now = simTime();
+    const TraceFile::Record* record;
+    while ((record = trace.peek()) != nullptr && recordTime(*record) <= now) {
+        trace.next();
+        sendHttpRequest(*record);
+        if (maxRecords > 0 && requestsSent >= maxRecords) {
+            return;  // Limit reached, no further timer
+        }
+    }
+    scheduleNextRecord();
+}
+
+void TraceReplay::scheduleNextRecord()
+{
+    const TraceFile::Record* record = trace.peek();
+    if (record) {
+        simtime_t due = recordTime(*record);
+        scheduleAt(due > simTime() ? due : simTime(), nextRecordTimer);
+    }
+}
+
+void TraceReplay::sendHttpRequest(const TraceFile::Record& record)
+{
+    int clientId = clientIdOffset + static_cast<int>(record.clientId);
+    int pageId = numResources > 0 ? static_cast<int>(record.resourceId % numResources) : static_cast<int>(record.resourceId);
+    requestCounter++;
+    requestsSent++;
+    traceBytes += record.bytes;
+    
+    // The client's previous request is the navigation source
+    int& previousPage = lastPage[static_cast<uint64_t>(clientId)];
+    int fromPage = (previousPage > 0) ? previousPage - 1 : -1;  // Stored +1 so 0 means none
+    previousPage = pageId + 1;
+    
+    HttpRequest *request = new HttpRequest("HttpRequest");
+    request->setRequestId(requestCounter);
+    request->setClientId(clientId);
+    request->setResourceId(pageId);
+    request->setFromPage(fromPage);
+    request->setResponseSize(static_cast<int>(std::min<uint32_t>(record.bytes, INT32_MAX)));  // 0: unknown, the page's own size
+    request->setTimestamp(simTime());
+    request->setByteLength(requestFormat.messageBytes(request->getUrl().length()));
+    
+    pendingRequests[makeRequestKey(clientId, requestCounter)] = simTime();
+    txQueue.send(request);
+    
+    emit(requestSentSignal, requestsSent);
+    
+    LOG_EV << "Trace client " << clientId << " sent request " << requestCounter
+       << " for page " << pageId << " (from page " << fromPage << ")" << endl;
+}
+
+void TraceReplay::handleHttpResponse(HttpResponse *response)
+{
+    // Trace clients have no browser cache
+    if (response->isPushed()) {
+        return;
+    }
+    
+    uint64_t key = makeRequestKey(response->getClientId(), response->getRequestId());
+    
+    // The first chunk (or the whole response) marks the first byte
+    if (response->getChunkIndex() == 0) {
+        simtime_t *sendTime = pendingRequests.find(key);
+        if (sendTime) {
+            emit(timeToFirstByteSignal, (simTime() - *sendTime).dbl());
+        }
+    }
+    
+    // A chunked response is complete with its last chunk
+    if (!response->isLastChunk()) {
+        return;
+    }
+    
+    simtime_t sendTime;
+    if (!pendingRequests.take(key, sendTime)) {
+        EV << "WARNING: Received response for unknown request " << response->getRequestId() << endl;
+        return;
+    }
+    
+    responsesReceived++;
+    if (response->getStatusCode() == 404) {
+        notFound++;
+    }
+    double responseTime = (simTime() - sendTime).dbl();
+    responseTimeSum += responseTime;
+    emit(responseTimeSignal, responseTime);
+    emit(responseReceivedSignal, responsesReceived);
+}
+
+void TraceReplay::finish()
+{
+    EV << "TraceReplay statistics:" << endl;
+    EV << "  Trace records replayed: " << trace.getPosition() << " of " << trace.getRecordCount() << endl;
+    EV << "  Total responses received: " << responsesReceived << endl;
+    EV << "  Distinct clients: " << lastPage.size() << endl;
+    
+    // Record scalar statistics
+    recordScalar("traceRecords", trace.getRecordCount());
+    recordScalar("requestsSent", requestsSent);
+    recordScalar("responsesReceived", responsesReceived);
+    recordScalar("responseRate", requestsSent > 0 ? (double)responsesReceived / requestsSent : 0);
+    recordScalar("avgResponseTime", responsesReceived > 0 ? responseTimeSum / responsesReceived : 0.0);
+    recordScalar("notFound", notFound);
+    recordScalar("traceBytes", traceBytes);
+    recordScalar("distinctClients", lastPage.size());
+    
+    // Clean up
+    cancelAndDelete(nextRecordTimer);
+    txQueue.clear();
+    trace.close();
+}
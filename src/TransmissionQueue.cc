@@ -0,0 +1,113 @@
+#include "TransmissionQueue.h"
+#include <string>
+
+// Constructors
+TransmissionQueue::TransmissionQueue()
+{
+    owner = nullptr;
+    gate = nullptr;
+    channel = nullptr;
+    readyTimer = nullptr;
+    busySignal = 0;
+    queueingDelaySignal = 0;
+    busyTime = SIMTIME_ZERO;
+    startTime = SIMTIME_ZERO;
+    packetsSent = 0;
+    bytesSent = 0;
+    maxLength = 0;
+}
+
+// Setup
+void TransmissionQueue::init(cSimpleModule* module, cGate* outGate, simsignal_t delaySignal)
+{
+    owner = module;
+    gate = outGate;
+    channel = gate->findTransmissionChannel();
+    queueingDelaySignal = delaySignal;
+    startTime = simTime();
+    
+    readyTimer = new cMessage("TxReady", TIMER_KIND);
+    readyTimer->setContextPointer(this);
+    
+    // One utilisation statistic per link, e.g. linkUtilization_out[3]
+    std::string gateName = gate->getFullName();
+    busySignal = owner->registerSignal(("linkBusy_" + gateName).c_str());
+    cProperty* statisticTemplate = owner->getProperties()->get("statisticTemplate", "linkUtilization");
+    if (statisticTemplate && channel) {
+        getEnvir()->addResultRecorders(owner, busySignal, ("linkUtilization_" + gateName).c_str(), statisticTemplate);
+        owner->emit(busySignal, 0L);
+    }
+}
+
+void TransmissionQueue::clear()
+{
+    for (auto& waiting : packets) {
+        delete waiting.first;
+    }
+    for (auto& waiting : background) {
+        delete waiting.first;
+    }
+    packets.clear();
+    background.clear();
+    if (owner && readyTimer) {
+        owner->cancelAndDelete(readyTimer);
+    }
+    readyTimer = nullptr;
+}
+
+// Operations
+void TransmissionQueue::send(cPacket* packet, bool lowPriority)
+{
+    if (!channel || (getLength() == 0 && !readyTimer->isScheduled() && !channel->isBusy())) {
+        transmit(packet);
+        return;
+    }
+    
+    (lowPriority ? background : packets).push_back(std::make_pair(packet, simTime()));
+    if ((size_t)getLength() > maxLength) {
+        maxLength = getLength();
+    }
+}
+
+void TransmissionQueue::handleTimer(cMessage* msg)
+{
+    TransmissionQueue* queue = static_cast<TransmissionQueue*>(msg->getContextPointer());
+    queue->owner->emit(queue->busySignal, 0L);
+    queue->transmitNext();
+}
+
+double TransmissionQueue::getUtilization(simtime_t now) const
+{
+    simtime_t elapsed = now - startTime;
+    return elapsed > SIMTIME_ZERO ? SIMTIME_DBL(busyTime) / SIMTIME_DBL(elapsed) : 0.0;
+}
+
+// Private helper methods
+void TransmissionQueue::transmit(cPacket* packet)
+{
+    packetsSent++;
+    bytesSent += packet->getByteLength();
+    owner->send(packet, gate);
+    if (!channel) {
+        return;
+    }
+    
+    // The timer marks the end of this transmission
+    simtime_t finishTime = channel->getTransmissionFinishTime();
+    busyTime += finishTime - simTime();
+    owner->emit(busySignal, 1L);
+    owner->scheduleAt(finishTime, readyTimer);
+}
+
+void TransmissionQueue::transmitNext()
+{
+    std::deque<std::pair<cPacket*, simtime_t>>& queue = packets.empty() ? background : packets;
+    if (queue.empty()) {
+        return;
+    }
+    
+    std::pair<cPacket*, simtime_t> next = queue.front();
+    queue.pop_front();
+    owner->emit(queueingDelaySignal, SIMTIME_DBL(simTime() - next.second));
+    transmit(next.first);
+}
@@ -0,0 +1,64 @@
+#ifndef TRANSMISSIONQUEUE_H
+#define TRANSMISSIONQUEUE_H
+
+#include <omnetpp.h>
+#include <deque>
+#include <utility>
+
+using namespace omnetpp;
+
+/**
+ * FIFO of packets waiting for one output link
+ * A DatarateChannel carries one packet at a time, so packets sent while it
+ * is transmitting wait here; a timer at the transmission finish time sends
+ * the next one. The link's busy state is emitted on a per-gate signal that
+ * the owner's linkUtilization statistic template records (timeavg = utilisation).
+ * Background packets (server push) only go out when no normal packet waits.
+ * Gates without a datarate channel send immediately.
+ */
+class TransmissionQueue
+{
+public:
+    static const short TIMER_KIND = 100;  // Message kind of the ready timer
+
+private:
+    cSimpleModule* owner;
+    cGate* gate;
+    cChannel* channel;  // nullptr: no transmission delay on this gate
+    cMessage* readyTimer;  // Context pointer is this queue
+    std::deque<std::pair<cPacket*, simtime_t>> packets;  // Waiting packets and their enqueue time
+    std::deque<std::pair<cPacket*, simtime_t>> background;  // Sent only when packets is empty
+    simsignal_t busySignal;
+    simsignal_t queueingDelaySignal;
+    simtime_t busyTime;
+    simtime_t startTime;
+    long packetsSent;
+    int64_t bytesSent;
+    size_t maxLength;
+
+public:
+    // Constructors
+    TransmissionQueue();
+    
+    // Setup (the vector holding queues must not reallocate afterwards)
+    void init(cSimpleModule* module, cGate* outGate, simsignal_t delaySignal);
+    void clear();  // Deletes waiting packets and the timer (call from finish())
+    
+    // Operations
+    void send(cPacket* packet, bool lowPriority = false);  // Transmit now or queue behind the current transmission
+    static bool isTimer(const cMessage* msg) { return msg->getKind() == TIMER_KIND && msg->isSelfMessage(); }
+    static void handleTimer(cMessage* msg);  // Dispatches to the queue that owns it
+    
+    // Getters
+    int getLength() const { return packets.size() + background.size(); }
+    size_t getMaxLength() const { return maxLength; }
+    long getPacketsSent() const { return packetsSent; }
+    int64_t getBytesSent() const { return bytesSent; }
+    double getUtilization(simtime_t now) const;
+
+private:
+    void transmit(cPacket* packet);
+    void transmitNext();
+};
+
+#endif // TRANSMISSIONQUEUE_H
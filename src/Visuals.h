@@ -0,0 +1,25 @@
+#ifndef VISUALS_H
+#define VISUALS_H
+
+#include <omnetpp.h>
+
+using namespace omnetpp;
+
+/**
+ * Switches for GUI feedback and per-request logging
+ * IF_VISUALIZE guards bubble()/display-string updates and LOG_EV replaces
+ * EV for per-request log lines; both expect the module's 'visualize' and
+ * 'verbose' members. When a switch is off the guarded statement is skipped,
+ * including building its string arguments. Building with
+ * -DHTTPCACHE_NO_VISUALS (make NO_VISUALS=1) removes the code entirely.
+ */
+#ifdef HTTPCACHE_NO_VISUALS
+#define HTTPCACHE_VISUALS_ENABLED false
+#else
+#define HTTPCACHE_VISUALS_ENABLED true
+#endif
+
+#define IF_VISUALIZE if (HTTPCACHE_VISUALS_ENABLED && visualize)
+#define LOG_EV if (!(HTTPCACHE_VISUALS_ENABLED && verbose)) {} else EV
+
+#endif // VISUALS_H
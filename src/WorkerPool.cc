@@ -0,0 +1,102 @@
+#include "WorkerPool.h"
+#include <algorithm>
+
+// Constructors
+WorkerPool::WorkerPool(const std::string& poolName)
+{
+    name = poolName;
+    numWorkers = 0;
+    queueCapacity = -1;
+    discipline = FIFO;
+    busyWorkers = 0;
+    nextSequence = 0;
+}
+
+// Destructor
+WorkerPool::~WorkerPool()
+{
+    clear();
+}
+
+void WorkerPool::configure(int workers, int capacity, const std::string& queueDiscipline)
+{
+    if (workers < 0) {
+        throw cRuntimeError("%s: number of workers must be >= 0 (0 = unlimited), got %d", name.c_str(), workers);
+    }
+    if (capacity < -1) {
+        throw cRuntimeError("%s: queue capacity must be >= -1 (-1 = unbounded), got %d", name.c_str(), capacity);
+    }
+    
+    if (queueDiscipline == "fifo") {
+        discipline = FIFO;
+    } else if (queueDiscipline == "priority") {
+        discipline = PRIORITY;
+    } else {
+        throw cRuntimeError("%s: unknown queue discipline '%s' (expected fifo or priority)", name.c_str(), queueDiscipline.c_str());
+    }
+    
+    numWorkers = workers;
+    queueCapacity = capacity;
+}
+
+void WorkerPool::release()
+{
+    if (busyWorkers > 0) {
+        busyWorkers--;
+    }
+}
+
+bool WorkerPool::enqueue(PendingResponse* msg, simtime_t serviceTime, int priority, simtime_t now)
+{
+    if (queueCapacity >= 0 && static_cast<int>(queue.size()) >= queueCapacity) {
+        return false;  // Caller still owns the message
+    }
+    
+    queue.push_back(Job{msg, serviceTime, now, priority, nextSequence++});
+    std::push_heap(queue.begin(), queue.end(), [this](const Job& a, const Job& b) { return servedAfter(a, b); });
+    return true;
+}
+
+WorkerPool::Job WorkerPool::dequeue()
+{
+    std::pop_heap(queue.begin(), queue.end(), [this](const Job& a, const Job& b) { return servedAfter(a, b); });
+    Job job = queue.back();
+    queue.pop_back();
+    return job;
+}
+
+bool WorkerPool::raisePriority(const PendingResponse* msg, int priority)
+{
+    for (auto& job : queue) {
+        if (job.msg == msg) {
+            if (priority < job.priority) {
+                job.priority = priority;  // Keeps its arrival order among equal priorities
+                std::make_heap(queue.begin(), queue.end(), [this](const Job& a, const Job& b) { return servedAfter(a, b); });
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkerPool::clear()
+{
+    for (auto& job : queue) {
+        delete job.msg;
+    }
+    queue.clear();
+}
+
+bool WorkerPool::servedAfter(const Job& a, const Job& b) const
+{
+    // Max-heap comparator: the job served first ends up on top
+    bool aBackground = a.priority >= BACKGROUND_PRIORITY;
+    bool bBackground = b.priority >= BACKGROUND_PRIORITY;
+    if (aBackground != bBackground) {
+        return aBackground;
+    }
+    if (discipline == PRIORITY && a.priority != b.priority) {
+        return a.priority > b.priority;
+    }
+    return a.sequence > b.sequence;
+}
@@ -0,0 +1,81 @@
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <omnetpp.h>
+#include <vector>
+#include <string>
+#include "HttpMessage.h"
+
+using namespace omnetpp;
+
+/**
+ * Bounded pool of server workers with a waiting queue
+ * A job holds one worker for its service time; jobs that find all workers
+ * busy wait in the queue (FIFO, or by priority then arrival order) and are
+ * refused once the queue is full. numWorkers = 0 means unlimited workers.
+ * Background jobs (BACKGROUND_PRIORITY and above) wait behind all other jobs
+ * under either discipline, so optional work never delays demand.
+ */
+class WorkerPool
+{
+public:
+    enum Discipline { FIFO, PRIORITY };
+    static const int BACKGROUND_PRIORITY = 2;
+    
+    // Queued job; the pool owns the message while it waits
+    struct Job {
+        PendingResponse* msg;
+        simtime_t serviceTime;
+        simtime_t enqueueTime;
+        int priority;  // Lower is served first (PRIORITY discipline only)
+        unsigned long sequence;  // Arrival order, breaks priority ties
+    };
+
+private:
+    std::string name;
+    int numWorkers;  // 0: unlimited
+    int queueCapacity;  // -1: unbounded, 0: no waiting room
+    Discipline discipline;
+    int busyWorkers;
+    std::vector<Job> queue;  // Heap ordered by (priority, sequence)
+    unsigned long nextSequence;
+
+public:
+    // Constructors
+    WorkerPool(const std::string& poolName = "workers");
+    
+    // Destructor
+    ~WorkerPool();
+    
+    // Configuration, throws cRuntimeError on invalid values
+    void configure(int workers, int capacity, const std::string& queueDiscipline);
+    
+    // Worker management
+    bool hasIdleWorker() const { return numWorkers == 0 || busyWorkers < numWorkers; }
+    void acquire() { busyWorkers++; }
+    void release();
+    
+    // Queue management
+    bool enqueue(PendingResponse* msg, simtime_t serviceTime, int priority, simtime_t now);  // false if full
+    bool hasQueuedJob() const { return !queue.empty(); }
+    Job dequeue();  // Next job to serve, only valid if hasQueuedJob()
+    bool raisePriority(const PendingResponse* msg, int priority);  // false if msg is not queued; O(queue length)
+    void clear();  // Deletes all queued messages
+    
+    // Getters
+    const std::string& getName() const { return name; }
+    int getNumWorkers() const { return numWorkers; }
+    int getBusyWorkers() const { return busyWorkers; }
+    int getQueueLength() const { return queue.size(); }
+    int getQueueCapacity() const { return queueCapacity; }
+    Discipline getDiscipline() const { return discipline; }
+
+private:
+    // Non-copyable: queued messages are owned
+    WorkerPool(const WorkerPool& other);
+    WorkerPool& operator=(const WorkerPool& other);
+    
+    bool servedAfter(const Job& a, const Job& b) const;
+};
+
+#endif // WORKERPOOL_H
@@ -0,0 +1,291 @@
+#!/usr/bin/env python3
+"""
+Run the run matrix of simulation configurations in parallel and aggregate the results
+
+Every run of each configuration (all iteration-variable combinations x repeat)
+is started as its own Cmdenv process, on as many local cores as requested and
+optionally on further hosts over ssh. OMNeT++ gives each run its own seed set
+(seed-set = run number) and its own result files (${configname}-${iterationvarsf}#${repetition}).
+Afterwards the scalar files are grouped by configuration and iteration
+variables, and each metric is reported as the mean over repetitions with a
+95% confidence interval (Student t). With --paired, every other group is also
+compared with a reference group run by run, matching runs by seed set: on
+common random numbers (see Configuration PairedComparison) the interval of
+these differences is much narrower than the difference of the two intervals.
+
+Remote hosts must see the project at the same path (shared filesystem) and
+have it built; each host is given as name or name:slots.
+
+Usage:
+  runall.py -c Sweep                      all runs of Sweep on every local core
+  runall.py -c Baseline -c Predictive -j 16 --csv compare.csv
+  runall.py -c Sweep --hosts node1:32,node2:32
+  runall.py -c Sweep --aggregate-only     table from existing result files
+  runall.py -c PairedComparison --paired  differences to the first group, paired by seed set
+"""
+
+import argparse
+import csv
+import glob
+import math
+import os
+import queue
+import shlex
+import subprocess
+import sys
+import threading
+import time
+
+TOOLS_DIR = os.path.dirname(os.path.abspath(__file__))
+SIM_DIR = os.path.join(os.path.dirname(TOOLS_DIR), "simulations")
+
+# (column, scalar name, module name suffix); values of matching modules are averaged per run
+METRICS = [
+    ("hitRate%", "finalCacheHitRate", ".server"),
+    ("meanLatency", "responseTimeStats:mean", ".server"),
+    ("p50Latency", "responseTimeStats:p50", ".server"),
+    ("p99Latency", "responseTimeStats:p99", ".server"),
+    ("prefetchPrecision", "prefetchPrecision", ".server"),
+    ("requests", "requestsReceived", ".server"),
+]
+
+# Two-sided 95% Student t quantiles by degrees of freedom
+T95 = [12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+       2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+       2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042]
+
+
+def query_runs(args, config):
+    command = [args.run, "-u", "Cmdenv", "-c", config, "-s", "-q", "runnumbers"] + args.ini
+    if args.filter:
+        command += ["-r", args.filter]
+    output = subprocess.run(command, cwd=SIM_DIR, capture_output=True, text=True)
+    lines = [line for line in output.stdout.splitlines() if line.strip()]
+    if output.returncode != 0 or not lines:
+        sys.exit("error: cannot list runs of %s:\n%s" % (config, output.stderr or output.stdout))
+    return [int(token) for token in lines[-1].split() if token.isdigit()]
+
+
+def run_command(args, config, run):
+    command = [args.run, "-u", "Cmdenv", "-c", config, "-r", str(run), "--cmdenv-express-mode=true",
+               "--result-dir=" + args.result_dir] + args.ini + args.extra
+    return command
+
+
+def execute(args, jobs):
+    # One worker thread per slot: "" = local, otherwise an ssh host
+    slots = [""] * args.jobs
+    for host in args.hosts:
+        name, _, count = host.partition(":")
+        slots += [name] * int(count or 1)
+    pending = queue.Queue()
+    for job in jobs:
+        pending.put(job)
+
+    log_dir = os.path.join(SIM_DIR, args.result_dir, "logs")
+    os.makedirs(log_dir, exist_ok=True)
+    failures = []
+    done = [0]
+    lock = threading.Lock()
+    started = time.time()
+
+    def worker(slot):
+        while True:
+            try:
+                config, run = pending.get_nowait()
+            except queue.Empty:
+                return
+            command = run_command(args, config, run)
+            if slot:
+                command = ["ssh", slot, "cd %s && %s" % (shlex.quote(SIM_DIR), " ".join(shlex.quote(c) for c in command))]
+            log_path = os.path.join(log_dir, "%s-%d.log" % (config, run))
+            with open(log_path, "w") as log:
+                code = subprocess.call(command, cwd=SIM_DIR, stdout=log, stderr=subprocess.STDOUT)
+            with lock:
+                done[0] += 1
+                if code != 0:
+                    failures.append((config, run, log_path))
+                print("[%d/%d] %s #%d %s%s (%.0fs)" % (done[0], len(jobs), config, run,
+                      "failed" if code else "done", " on " + slot if slot else "", time.time() - started))
+
+    threads = [threading.Thread(target=worker, args=(slot,)) for slot in slots]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    return failures
+
+
+def read_scalars(path):
+    """One scalar file: list of (config, iterationvars, seedset, {(module, name): value}) per run"""
+    runs = []
+    current = None
+    with open(path, "r", errors="replace") as source:
+        for line in source:
+            if line.startswith("run "):
+                current = {"config": "", "itervars": "", "seedset": None, "scalars": {}}
+                runs.append(current)
+            elif current is None:
+                continue
+            elif line.startswith("attr configname "):
+                current["config"] = line.split(None, 2)[2].strip()
+            elif line.startswith("attr seedset "):
+                current["seedset"] = line.split(None, 2)[2].strip()
+            elif line.startswith("attr iterationvars "):
+                current["itervars"] = line.split(None, 2)[2].strip().strip('"')
+            elif line.startswith("scalar "):
+                parts = line.split()
+                if len(parts) >= 4:
+                    try:
+                        current["scalars"][(parts[1], parts[2])] = float(parts[3])
+                    except ValueError:
+                        pass  # nan/inf written as text
+    return runs
+
+
+def metric_value(scalars, name, suffix):
+    values = [value for (module, scalar), value in scalars.items()
+              if scalar == name and module.rstrip("]0123456789").rstrip("[").endswith(suffix)]
+    return sum(values) / len(values) if values else None
+
+
+def confidence(values):
+    """Mean and 95% half-width (0 for a single value)"""
+    count = len(values)
+    mean = sum(values) / count
+    if count < 2:
+        return mean, 0.0
+    variance = sum((value - mean) ** 2 for value in values) / (count - 1)
+    t = T95[count - 2] if count - 2 < len(T95) else 1.960
+    return mean, t * math.sqrt(variance / count)
+
+
+def aggregate(args, since):
+    groups = {}
+    for path in sorted(glob.glob(os.path.join(SIM_DIR, args.result_dir, "*.sca"))):
+        if os.path.getmtime(path) < since:
+            continue  # Left over from an earlier invocation
+        for run in read_scalars(path):
+            if args.configs and run["config"] not in args.configs:
+                continue
+            groups.setdefault((run["config"], run["itervars"]), []).append(run)
+
+    header = ["config", "itervars", "runs"]
+    for column_name, _, _ in METRICS:
+        header += [column_name, "+-95%"]
+    rows = []
+    for (config, itervars), runs in sorted(groups.items()):
+        row = [config, itervars, str(len(runs))]
+        for _, name, suffix in METRICS:
+            values = [v for v in (metric_value(run["scalars"], name, suffix) for run in runs) if v is not None]
+            row += format_interval(values)
+        rows.append(row)
+
+    if not rows:
+        print("no scalar results found in %s" % os.path.join(SIM_DIR, args.result_dir), file=sys.stderr)
+        return
+    print_table(header, rows)
+    if args.paired:
+        print()
+        paired_differences(args, groups, header)
+    if args.csv:
+        with open(args.csv, "w", newline="") as out:
+            writer = csv.writer(out)
+            writer.writerow(header)
+            writer.writerows(rows)
+        print("-> %s" % args.csv)
+
+
+def format_interval(values):
+    if not values:
+        return ["-", "-"]
+    mean, half_width = confidence(values)
+    return ["%.4g" % mean, "%.2g" % half_width]
+
+
+def print_table(header, rows):
+    widths = [max(len(row[i]) for row in [header] + rows) for i in range(len(header))]
+    for row in [header] + rows:
+        print("  ".join(cell.ljust(width) for cell, width in zip(row, widths)))
+
+
+def paired_differences(args, groups, header):
+    """Per-seed-set differences of every group to the reference group"""
+    keys = sorted(groups)
+    if args.reference:
+        matches = [key for key in keys if args.reference in "%s %s" % key]
+        if not matches:
+            sys.exit("error: no result group matches --reference %s" % args.reference)
+        reference = matches[0]
+    else:
+        reference = keys[0]
+    reference_runs = {run["seedset"]: run["scalars"] for run in groups[reference]}
+
+    rows = []
+    for key in keys:
+        if key == reference:
+            continue
+        runs = [run for run in groups[key] if run["seedset"] in reference_runs]
+        row = [key[0], key[1], str(len(runs))]
+        for _, name, suffix in METRICS:
+            differences = []
+            for run in runs:
+                value = metric_value(run["scalars"], name, suffix)
+                base = metric_value(reference_runs[run["seedset"]], name, suffix)
+                if value is not None and base is not None:
+                    differences.append(value - base)
+            row += format_interval(differences)
+        rows.append(row)
+    print("difference to %s %s, paired by seed set:" % reference)
+    if rows:
+        print_table(header, rows)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("-c", "--config", dest="configs", action="append", default=[],
+                        help="configuration to run (repeatable)")
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count() or 1, help="local parallel runs (default: cores)")
+    parser.add_argument("-r", "--filter", help="OMNeT++ run filter, e.g. '$threshold==0.6' or 0..5")
+    parser.add_argument("--hosts", default="", help="extra ssh hosts as name[:slots],... (shared filesystem)")
+    parser.add_argument("--ini", nargs="*", default=[], help="ini files (default: simulations/omnetpp.ini)")
+    parser.add_argument("--run", default="./run", help="simulation launcher, relative to simulations/")
+    parser.add_argument("--result-dir", default="results", help="result directory, relative to simulations/")
+    parser.add_argument("--csv", help="also write the comparison table to this CSV file")
+    parser.add_argument("--paired", action="store_true",
+                        help="also show differences to a reference group, run pairs matched by seed set")
+    parser.add_argument("--reference", help="reference group for --paired: text in 'config itervars' (default: first)")
+    parser.add_argument("--aggregate-only", action="store_true", help="do not run, aggregate existing results")
+    parser.add_argument("--dry-run", action="store_true", help="print the run commands only")
+    parser.add_argument("extra", nargs="*", help="further simulation options, after --")
+    args = parser.parse_args()
+    args.hosts = [host for host in args.hosts.split(",") if host]
+    args.jobs = max(0, args.jobs)
+    if args.jobs == 0 and not args.hosts:
+        sys.exit("error: no local jobs and no hosts")
+
+    if args.aggregate_only:
+        aggregate(args, 0)
+        return
+    if not args.configs:
+        sys.exit("error: give at least one configuration with -c")
+
+    jobs = [(config, run) for config in args.configs for run in query_runs(args, config)]
+    if args.dry_run:
+        for config, run in jobs:
+            print(" ".join(shlex.quote(c) for c in run_command(args, config, run)))
+        return
+
+    print("%d runs on %d local slots%s" % (len(jobs), args.jobs,
+          " and " + ", ".join(args.hosts) if args.hosts else ""))
+    started = time.time()
+    failures = execute(args, jobs)
+    aggregate(args, started - 1)
+    if failures:
+        for config, run, log_path in failures:
+            print("failed: %s #%d, see %s" % (config, run, log_path), file=sys.stderr)
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
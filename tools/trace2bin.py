@@ -0,0 +1,166 @@
+#!/usr/bin/env python3
+"""
+Convert web access logs to the binary trace format read by TraceReplay (.htrc)
+
+Input formats:
+  clf  Common / Combined Log Format
+       host ident user [10/Oct/2000:13:55:36 -0700] "GET /index.html HTTP/1.0" 200 2326 ...
+  csv  Header row with columns time (seconds, may be fractional), client, resource
+       and optionally bytes; 'timestamp'/'clientId'/'resourceId'/'url'/'size' are
+       accepted as column names too
+
+Clients and resources that are not plain integers (hosts, URLs) get dense ids
+in order of first appearance; --map writes the resource mapping as CSV.
+The log is streamed, so only the id maps are held in memory. Records must be
+in time order; slightly out-of-order lines are clamped to the previous time.
+
+Output layout (little-endian), see src/TraceFile.h:
+  header  char[8] "HTTRACE1", u32 recordSize=24, u32 flags=0, u64 recordCount, i64 startTimeUs
+  record  i64 timeUs (since first record), u32 clientId, u32 resourceId, u32 bytes, u32 reserved
+
+Usage:
+  trace2bin.py access.log trace.htrc
+  trace2bin.py --format csv --map pages.csv requests.csv trace.htrc
+"""
+
+import argparse
+import csv
+import gzip
+import re
+import struct
+import sys
+from datetime import datetime
+
+HEADER = struct.Struct("<8sIIQq")
+RECORD = struct.Struct("<qIIII")
+MAGIC = b"HTTRACE1"
+
+CLF_LINE = re.compile(r'(\S+) \S+ \S+ \[([^\]]+)\] "(\S+) (\S+)[^"]*" (\d{3}) (\d+|-)')
+CLF_TIME = "%d/%b/%Y:%H:%M:%S %z"
+
+
+class IdMap:
+    """Dense ids for non-numeric keys; numeric keys are kept as they are"""
+
+    def __init__(self, numeric):
+        self.numeric = numeric
+        self.ids = {}
+
+    def get(self, key):
+        if self.numeric:
+            return int(key)
+        value = self.ids.get(key)
+        if value is None:
+            value = len(self.ids)
+            self.ids[key] = value
+        return value
+
+
+def open_text(path):
+    if path == "-":
+        return sys.stdin
+    if path.endswith(".gz"):
+        return gzip.open(path, "rt", encoding="utf-8", errors="replace")
+    return open(path, "r", encoding="utf-8", errors="replace", newline="")
+
+
+def parse_clf(source, args, clients, resources):
+    skipped = 0
+    for line in source:
+        match = CLF_LINE.match(line)
+        if not match:
+            skipped += 1
+            continue
+        host, stamp, method, url, status, size = match.groups()
+        if args.methods and method not in args.methods:
+            continue
+        if args.only_ok and not status.startswith(("2", "3")):
+            continue
+        if args.strip_query:
+            url = url.split("?", 1)[0]
+        seconds = datetime.strptime(stamp, CLF_TIME).timestamp()
+        yield seconds, clients.get(host), resources.get(url), 0 if size == "-" else int(size)
+    if skipped:
+        print("warning: %d unparsable lines skipped" % skipped, file=sys.stderr)
+
+
+def column(fields, *names):
+    for name in names:
+        if name in fields:
+            return name
+    return None
+
+
+def parse_csv(source, args, clients, resources):
+    reader = csv.DictReader(source)
+    fields = reader.fieldnames or []
+    time_col = column(fields, "time", "timestamp")
+    client_col = column(fields, "client", "clientId", "host")
+    resource_col = column(fields, "resource", "resourceId", "url", "page")
+    bytes_col = column(fields, "bytes", "size")
+    if not (time_col and client_col and resource_col):
+        sys.exit("error: CSV needs time, client and resource columns (found: %s)" % ", ".join(fields))
+    for row in reader:
+        size = row.get(bytes_col) if bytes_col else None
+        yield (float(row[time_col]), clients.get(row[client_col]), resources.get(row[resource_col]),
+               int(size) if size else 0)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", help="access log (.gz is decompressed, - reads stdin)")
+    parser.add_argument("output", help="binary trace to write (.htrc)")
+    parser.add_argument("--format", choices=["auto", "clf", "csv"], default="auto")
+    parser.add_argument("--map", help="write the resource -> resourceId mapping to this CSV file")
+    parser.add_argument("--methods", nargs="*", default=["GET"], help="CLF methods to keep (default GET, none = all)")
+    parser.add_argument("--only-ok", action="store_true", help="CLF: keep 2xx/3xx responses only")
+    parser.add_argument("--strip-query", action="store_true", help="CLF: drop the query string from URLs")
+    parser.add_argument("--numeric-ids", action="store_true", help="CSV: client and resource columns are integer ids")
+    args = parser.parse_args()
+
+    fmt = args.format
+    if fmt == "auto":
+        fmt = "csv" if args.input.endswith((".csv", ".csv.gz")) else "clf"
+
+    numeric = args.numeric_ids and fmt == "csv"
+    clients = IdMap(numeric)
+    resources = IdMap(numeric)
+    parse = parse_clf if fmt == "clf" else parse_csv
+
+    count = 0
+    clamped = 0
+    first = None
+    last_us = 0
+    with open_text(args.input) as source, open(args.output, "wb") as out:
+        out.write(HEADER.pack(MAGIC, RECORD.size, 0, 0, 0))  # Count patched at the end
+        for seconds, client, resource, size in parse(source, args, clients, resources):
+            if first is None:
+                first = seconds
+            time_us = int(round((seconds - first) * 1e6))
+            if time_us < last_us:
+                time_us = last_us
+                clamped += 1
+            last_us = time_us
+            out.write(RECORD.pack(time_us, client & 0xFFFFFFFF, resource & 0xFFFFFFFF, min(size, 0xFFFFFFFF), 0))
+            count += 1
+        out.seek(0)
+        out.write(HEADER.pack(MAGIC, RECORD.size, 0, count, int(round((first or 0) * 1e6))))
+
+    if args.map and not numeric:
+        with open(args.map, "w", newline="") as mapping:
+            writer = csv.writer(mapping)
+            writer.writerow(["resourceId", "resource"])
+            for key, value in resources.ids.items():
+                writer.writerow([value, key])
+
+    if numeric:
+        print("%d records, %.1f s -> %s" % (count, last_us / 1e6, args.output))
+    else:
+        print("%d records, %.1f s, %d clients, %d resources -> %s" %
+              (count, last_us / 1e6, len(clients.ids), len(resources.ids), args.output))
+    if clamped:
+        print("warning: %d out-of-order records clamped to the previous time" % clamped, file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()